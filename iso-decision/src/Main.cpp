@@ -28,6 +28,36 @@ char* boolToWord(bool b) {
 
 }
 
+/**
+ * the answers for m1 and m2 without any of the passes that only make the
+ * comparison cheaper: the models are not trimmed, reduced or minimized, and
+ * they are compared with fully built DWGs of the untrimmed witness graph.
+ * --check=both reports where these differ from the answers of the run.
+ */
+void plainCheck(const std::string &m1, const std::string &m2, const alignment &alm, bool &leftEqual, bool &rightEqual)
+{
+  Graph_t g1 = Graph::parse(m1);
+  Graph_t g2 = Graph::parse(m2);
+
+  groupingTable gt;
+  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1, Alm::Lhs(alm), gt);
+  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2, Alm::Rhs(alm), gt);
+
+  edgeLabelSet els1 = Helper::lgmFlatten(lgm1);
+  edgeLabelSet els2 = Helper::lgmFlatten(lgm2);
+
+  Helper::labelsToGroupings(g1, lgm1);
+  Helper::labelsToGroupings(g2, lgm2);
+
+  DG_t dg1 = DG::determinize(g1, els1);
+  DG_t dg2 = DG::determinize(g2, els2);
+
+  WG_t wg = WG::create(dg1, dg2, lgm1, lgm2, alm);
+
+  leftEqual = Cmp::isEqual(dg1, DWG::createLhs(wg, els1));
+  rightEqual = Cmp::isEqual(dg2, DWG::createRhs(wg, els2));
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -36,8 +66,33 @@ int main(int argc, char *argv[])
   // this has a slight performance overhead, so it might not be worth it.
   // auto vm = getProgramOptionDescription(argc, argv);
 
-  if (argc != 4) {
-    std::cout << "Usage: " << argv[0] << " m1.dot m2.dot alignment.json" << std::endl;
+  if (argc < 4 || argc > 6) {
+    std::cout << "Usage: " << argv[0] << " m1.dot m2.dot alignment.json [--check=dwg|antichain|both] [--verdict]" << std::endl;
+    return 0;
+  }
+
+  // how the behavior is compared with the witness graph: against the
+  // determinized witness graph (default), by the antichain search, or by both,
+  // reporting where they or the plain run (see plainCheck) disagree.
+  // --verdict only answers whether both machines are included, see below.
+  std::string check = "--check=dwg";
+  bool verdictOnly = false;
+
+  for (int i = 4; i < argc; ++i) {
+    std::string opt = argv[i];
+
+    if (opt == "--verdict")
+      verdictOnly = true;
+    else if (opt == "--check=dwg" || opt == "--check=antichain" || opt == "--check=both")
+      check = opt;
+    else {
+      std::cout << "Unknown option \"" << opt << "\"" << std::endl;
+      return 0;
+    }
+  }
+
+  if (verdictOnly && check != "--check=dwg") {
+    std::cout << "--verdict only works with --check=dwg" << std::endl;
     return 0;
   }
 
@@ -70,9 +125,11 @@ int main(int argc, char *argv[])
   alignment alm = Alm::parse(argv[3]);
 
   // extract the sets of alignment groups for both the left and right side of the alignment.
-  // for each label assign the groups it is contained in.
-  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1, Alm::Lhs(alm));
-  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2, Alm::Rhs(alm));
+  // for each label assign the groups it is contained in. groupings are interned
+  // into gt, which is shared by both sides.
+  groupingTable gt;
+  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1, Alm::Lhs(alm), gt);
+  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2, Alm::Rhs(alm), gt);
 
   // helper: get just the alignment groups without knowing to which label they belong.
   edgeLabelSet els1 = Helper::lgmFlatten(lgm1);
@@ -85,6 +142,19 @@ int main(int argc, char *argv[])
   Helper::labelsToGroupings(g1, lgm1);
   Helper::labelsToGroupings(g2, lgm2);
 
+  // drop the states that can never reach an end state, see Graph::trim. this
+  // comes after the groupings are taken from the labels, so the labels of
+  // the dropped states still count.
+  g1 = Graph::trim(g1);
+  g2 = Graph::trim(g2);
+
+#if ISO_LIB_REDUCE_MODELS
+  // merge states that only differ in unaligned behavior, so it does not blow
+  // up the determinization. see Graph::reduce.
+  g1 = Graph::reduce(g1);
+  g2 = Graph::reduce(g2);
+#endif
+
   // Graph::print(g1);
   // Graph::print(g2);
 
@@ -94,6 +164,12 @@ int main(int argc, char *argv[])
   DG_t dg1 = DG::determinize(g1, els1);
   DG_t dg2 = DG::determinize(g2, els2);
 
+#if ISO_LIB_MINIMIZE_DG
+  // merge equivalent states of the determinized models. see DG::minimize.
+  dg1 = DG::minimize(dg1);
+  dg2 = DG::minimize(dg2);
+#endif
+
   /*
   std::ofstream d1file;
   d1file.open("det_m1.dot");
@@ -101,8 +177,22 @@ int main(int argc, char *argv[])
   d1file.close();
   */
 
+  // only the verdict is asked for: the witness graph is not written, so it is
+  // only built as far as the comparison reads it (see WG::Builder), and the
+  // second machine is not compared once the first one failed.
+  if (verdictOnly) {
+    WG_t wg;
+    WG::Builder wgb(wg, dg1, dg2, lgm1, lgm2, alm);
+
+    bool bothEqual = Cmp::isEqualLhs(dg1, wgb, els1) && Cmp::isEqualRhs(dg2, wgb, els2);
+
+    std::cout << "Does the witness graph include all behavior of \"" << argv[1] << "\" and \"" << argv[2] << "\"? " << boolToWord(bothEqual) << std::endl;
+
+    return bothEqual ? 0 : 1;
+  }
+
   WG_t wg = WG::create(dg1, dg2, lgm1, lgm2, alm);
-  //WG::print(wg);
+  //WG::print(wg, dg1, dg2, gt);
 
   std::cout << "Created witness graph for machines \"" << argv[1] << "\" and \""  << argv[2] << "\" w.r.t. alignment \""  << argv[3] << "\"" << std::endl;
 
@@ -110,16 +200,49 @@ int main(int argc, char *argv[])
 
   std::ofstream myfile;
   myfile.open((std::string) argv[1] + "_" + (std::string) argv[2] + "_" + (std::string) argv[3] +  "_witness_graph.dot");
-  WG::write(wg,myfile);
+  WG::write(wg, dg1, dg2, gt, myfile);
   myfile.close();
 
   std::cout << "Comparing machine behavior with the witness graph... " << std::endl;
 
-  DWG_t dwg1 = DWG::createLhs(wg, els1);
-  DWG_t dwg2 = DWG::createRhs(wg, els2);
+  // the file has the whole witness graph, the comparison only needs the
+  // vertices that can reach a final one.
+  WG_t cmpWg = WG::trim(wg);
+
+  bool leftEqual;
+  bool rightEqual;
+
+  if (check == "--check=antichain") {
+    leftEqual = Cmp::isIncludedLhs(dg1, cmpWg, els1);
+    rightEqual = Cmp::isIncludedRhs(dg2, cmpWg, els2);
+  }
+  else {
+    leftEqual = Cmp::isEqualLhs(dg1, cmpWg, els1);
+    rightEqual = Cmp::isEqualRhs(dg2, cmpWg, els2);
+  }
+
+  if (check == "--check=both") {
+    bool leftIncluded = Cmp::isIncludedLhs(dg1, cmpWg, els1);
+    bool rightIncluded = Cmp::isIncludedRhs(dg2, cmpWg, els2);
+
+    if (leftIncluded != leftEqual)
+      std::cerr << "Antichain check disagrees on \"" << argv[1] << "\": " << boolToWord(leftIncluded) << std::endl;
+
+    if (rightIncluded != rightEqual)
+      std::cerr << "Antichain check disagrees on \"" << argv[2] << "\": " << boolToWord(rightIncluded) << std::endl;
+
+    bool leftPlain;
+    bool rightPlain;
+
+    plainCheck(argv[1], argv[2], alm, leftPlain, rightPlain);
+
+    if (leftPlain != leftEqual)
+      std::cerr << "Plain run disagrees on \"" << argv[1] << "\": " << boolToWord(leftPlain) << std::endl;
+
+    if (rightPlain != rightEqual)
+      std::cerr << "Plain run disagrees on \"" << argv[2] << "\": " << boolToWord(rightPlain) << std::endl;
+  }
 
-  bool leftEqual = Cmp::isEqual(dg1, dwg1, lgm1);
-  bool rightEqual = Cmp::isEqual(dg2, dwg2, lgm2);
   bool bothEqual = leftEqual && rightEqual;
 
   std::cout << "Does the witness graph include all behavior of \"" << argv[1] << "\"? " << boolToWord(leftEqual) << std::endl;
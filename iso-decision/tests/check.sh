@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# regression check for iso-decision: runs the decision on the models of an
+# example directory with --check=both and compares the answers with
+# expected.txt in that directory. the run fails as well if any of the checks
+# disagree with each other, or if the answer of --verdict does not match.
+#
+# usage: check.sh path/to/iso-decision path/to/example
+
+bin="$1"
+dir="$2"
+
+# iso-decision writes the witness graph next to its inputs, so it runs on a copy.
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+cp "$dir/m1.dot" "$dir/m2.dot" "$dir/alignment.json" "$tmp"
+
+cd "$tmp" || exit 1
+
+"$bin" m1.dot m2.dot alignment.json --check=both > out.txt 2> err.txt
+
+if [ -s err.txt ]; then
+  cat err.txt
+  exit 1
+fi
+
+grep "^Does" out.txt | diff "$dir/expected.txt" - || exit 1
+
+# --verdict answers for both machines at once, Yes iff both answers are.
+"$bin" m1.dot m2.dot alignment.json --verdict > verdict.txt
+
+if grep -q "No$" "$dir/expected.txt"; then
+  verdict=No
+else
+  verdict=Yes
+fi
+
+if ! grep -q "^Does .* $verdict\$" verdict.txt; then
+  echo "--verdict disagrees, expected $verdict:"
+  cat verdict.txt
+  exit 1
+fi
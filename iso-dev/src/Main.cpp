@@ -31,8 +31,9 @@ int main(int argc, char *argv[])
 
   alignment alm = Alm::parse(argv[3]);
 
-  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1, Alm::Lhs(alm));
-  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2, Alm::Rhs(alm));
+  groupingTable gt;
+  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1, Alm::Lhs(alm), gt);
+  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2, Alm::Rhs(alm), gt);
 
   edgeLabelSet els1 = Helper::lgmFlatten(lgm1);
   edgeLabelSet els2 = Helper::lgmFlatten(lgm2);
@@ -52,15 +53,15 @@ int main(int argc, char *argv[])
 
 
   //WG_t wg = WG::create(dg1, dg2, lgm1, lgm2, alm);
-  //WG::print(wg);
+  //WG::print(wg, dg1, dg2, gt);
 
   //DWG_t dwg1 = DWG::createLhs(wg, els1);
-  //DWG::print(dwg1);
+  //DWG::print(dwg1, wg, dg1, dg2, gt);
 
   //DWG_t dwg2 = DWG::createRhs(wg, els2);
 
-  //std::cout << "g1 vs dwgLhs: " << Cmp::isEqual(dg1, dwg1, lgm1) << std::endl;
-  //std::cout << "g2 vs dwgRhs: " << Cmp::isEqual(dg2, dwg2, lgm2) << std::endl;
+  //std::cout << "g1 vs dwgLhs: " << Cmp::isEqual(dg1, dwg1) << std::endl;
+  //std::cout << "g2 vs dwgRhs: " << Cmp::isEqual(dg2, dwg2) << std::endl;
 
 
 
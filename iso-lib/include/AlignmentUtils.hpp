@@ -8,13 +8,17 @@
 #include <vector>
 
 #include "json.hpp"
+#include "Bitset.hpp"
+#include "LabelUtils.hpp"
 #include "Utils.hpp"
 
 using json = nlohmann::json;
 
 
-using label             = std::string;
-using alignmentGroup    = std::vector<label>;
+// a group is a set of labels, stored as a bitmask over label ids, so membership
+// is a bit test and group equality does not depend on the order of the labels.
+using label             = labelId;
+using alignmentGroup    = Bitset;
 using alignmentGrouping = std::vector<alignmentGroup>;
 using alignmentPair     = std::pair<alignmentGroup, alignmentGroup>;
 using alignmentHalf     = alignmentGrouping;
@@ -23,6 +27,51 @@ using alignmentSub      = alignment;
 
 using almMap = std::map<alignmentGroup, alignmentGroup>;
 
+/**
+ * Pairs of an alignment by label: lhs[l] (rhs[l]) holds the indices of the
+ * pairs whose left (right) group contains label l. Stored as bitsets over the
+ * pair indices like match sets, so candidates for a label pair are a single
+ * intersection.
+ */
+struct alignmentIndex {
+  std::vector<Bitset> lhs;
+  std::vector<Bitset> rhs;
+};
+
+
+/**
+ * Id of an interned alignment grouping. Edges of all graphs carry grouping ids
+ * instead of copies of the grouping, so comparing groupings is an integer
+ * compare. Id 0 is reserved for the empty grouping, i.e. for labels that are
+ * not aligned at all.
+ */
+using groupingId = std::uint32_t;
+
+const groupingId emptyGrouping = 0;
+
+struct groupingHash {
+  std::size_t operator()(const alignmentGrouping &gp) const
+  {
+    std::size_t h = gp.size();
+
+    for (const alignmentGroup &g : gp)
+      h = (h * 31) ^ g.hash();
+
+    return h;
+  }
+};
+
+/**
+ * Hash-consing table for groupings. One table is shared by both sides of an
+ * alignment for the duration of a decision run.
+ */
+struct groupingTable {
+  std::vector<alignmentGrouping> groupings;
+  std::unordered_map<alignmentGrouping, groupingId, groupingHash> ids;
+
+  groupingTable() : groupings{alignmentGrouping()}, ids{{alignmentGrouping(), emptyGrouping}} {}
+};
+
 
 
 namespace Alm {
@@ -36,6 +85,12 @@ namespace Alm {
 
   almMap AlmMap(const alignment &alm);
 
+  alignmentIndex buildIndex(const alignment &alm);
+  const Bitset &pairsWithLhs(const alignmentIndex &idx, const label &l);
+  const Bitset &pairsWithRhs(const alignmentIndex &idx, const label &l);
+
+
+  void addLabel(alignmentGroup &g, const label &l);
 
   bool hasLabel(const alignmentGroup &g, const label &l);
   bool hasPair(const alignment &alm, const alignmentPair &p);
@@ -46,13 +101,18 @@ namespace Alm {
   label getLabelFromGrouping(const alignmentGrouping &gp);
   alignmentGrouping getGrouping(const label &l, const alignmentHalf &alh);
 
+  groupingId internGrouping(groupingTable &gt, const alignmentGrouping &gp);
+  const alignmentGrouping &lookupGrouping(const groupingTable &gt, const groupingId &id);
+
   int getPermissiveness(const alignment &alm);
 
 
 
 
+  std::vector<std::string> groupToNames(const alignmentGroup &g);
   std::string groupToStr(const alignmentGroup &g);
   std::string groupingToStr(const alignmentGrouping &gp);
+  std::string groupingToStr(const groupingTable &gt, const groupingId &id);
 
   void print(const alignment &a);
   void printPair(const alignmentPair &p);
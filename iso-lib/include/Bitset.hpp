@@ -0,0 +1,289 @@
+#ifndef __BITSET_HPP__
+#define __BITSET_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
+#include <boost/container/small_vector.hpp>
+
+#include "HashIndex.hpp"
+
+
+/**
+ * Compact set of small non-negative integers (label ids, alignment pair
+ * indices, state numbers).
+ *
+ * The first 128 bits are stored inline, so sets over small alphabets never
+ * allocate; larger universes spill into a heap buffer. Trailing zero words are
+ * always trimmed, which keeps the representation canonical: two bitsets are
+ * equal iff their word vectors are equal, independent of the order in which
+ * bits were set or of how large the universe has grown in the meantime.
+ *
+ * Iterating a Bitset yields the indices of its set bits in ascending order.
+ */
+class Bitset {
+public:
+  using word = std::uint64_t;
+  using words = boost::container::small_vector<word, 2>;
+
+  static const std::size_t wordBits = 64;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::size_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::size_t *;
+    using reference         = std::size_t;
+
+    const_iterator(const Bitset::words &ws, std::size_t w) : ws(&ws), w(w), curr(0)
+    {
+      if (w < ws.size())
+        curr = ws[w];
+
+      skip();
+    }
+
+    std::size_t operator*() const
+    {
+      return w * wordBits + __builtin_ctzll(curr);
+    }
+
+    const_iterator &operator++()
+    {
+      curr &= curr - 1;
+      skip();
+
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const
+    {
+      return (w == other.w) && (curr == other.curr);
+    }
+
+    bool operator!=(const const_iterator &other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    void skip()
+    {
+      while (curr == 0 && w < ws->size()) {
+        ++w;
+        curr = (w < ws->size()) ? (*ws)[w] : 0;
+      }
+    }
+
+    const Bitset::words *ws;
+    std::size_t w;
+    word curr;
+  };
+
+  void set(std::size_t i)
+  {
+    std::size_t w = i / wordBits;
+
+    if (w >= ws.size())
+      ws.resize(w + 1, 0);
+
+    ws[w] |= (word(1) << (i % wordBits));
+  }
+
+  void reset(std::size_t i)
+  {
+    std::size_t w = i / wordBits;
+
+    if (w >= ws.size())
+      return;
+
+    ws[w] &= ~(word(1) << (i % wordBits));
+    trim();
+  }
+
+  bool test(std::size_t i) const
+  {
+    std::size_t w = i / wordBits;
+
+    if (w >= ws.size())
+      return false;
+
+    return (ws[w] >> (i % wordBits)) & 1;
+  }
+
+  bool none() const
+  {
+    return ws.empty();
+  }
+
+  bool any() const
+  {
+    return !ws.empty();
+  }
+
+  std::size_t count() const
+  {
+    std::size_t n = 0;
+
+    for (const word &w : ws)
+      n += __builtin_popcountll(w);
+
+    return n;
+  }
+
+  /**
+   * index of the smallest element. must not be called on an empty set.
+   */
+  std::size_t first() const
+  {
+    return *begin();
+  }
+
+  void clear()
+  {
+    ws.clear();
+  }
+
+  bool intersects(const Bitset &other) const
+  {
+    std::size_t n = std::min(ws.size(), other.ws.size());
+
+    for (std::size_t i = 0; i < n; ++i) {
+      if (ws[i] & other.ws[i])
+        return true;
+    }
+
+    return false;
+  }
+
+  bool isSubsetOf(const Bitset &other) const
+  {
+    if (ws.size() > other.ws.size())
+      return false;
+
+    for (std::size_t i = 0; i < ws.size(); ++i) {
+      if (ws[i] & ~other.ws[i])
+        return false;
+    }
+
+    return true;
+  }
+
+  Bitset &operator|=(const Bitset &other)
+  {
+    if (other.ws.size() > ws.size())
+      ws.resize(other.ws.size(), 0);
+
+    for (std::size_t i = 0; i < other.ws.size(); ++i)
+      ws[i] |= other.ws[i];
+
+    return *this;
+  }
+
+  Bitset &operator&=(const Bitset &other)
+  {
+    if (ws.size() > other.ws.size())
+      ws.resize(other.ws.size());
+
+    for (std::size_t i = 0; i < ws.size(); ++i)
+      ws[i] &= other.ws[i];
+
+    trim();
+
+    return *this;
+  }
+
+  /**
+   * removes all elements of other from this set.
+   */
+  Bitset &operator-=(const Bitset &other)
+  {
+    std::size_t n = std::min(ws.size(), other.ws.size());
+
+    for (std::size_t i = 0; i < n; ++i)
+      ws[i] &= ~other.ws[i];
+
+    trim();
+
+    return *this;
+  }
+
+  friend Bitset operator|(Bitset a, const Bitset &b)
+  {
+    return a |= b;
+  }
+
+  friend Bitset operator&(Bitset a, const Bitset &b)
+  {
+    return a &= b;
+  }
+
+  friend Bitset operator-(Bitset a, const Bitset &b)
+  {
+    return a -= b;
+  }
+
+  bool operator==(const Bitset &other) const
+  {
+    return ws == other.ws;
+  }
+
+  bool operator!=(const Bitset &other) const
+  {
+    return ws != other.ws;
+  }
+
+  bool operator<(const Bitset &other) const
+  {
+    if (ws.size() != other.ws.size())
+      return ws.size() < other.ws.size();
+
+    return std::lexicographical_compare(ws.rbegin(), ws.rend(), other.ws.rbegin(), other.ws.rend());
+  }
+
+  /**
+   * every word is mixed before it is folded in and the result is mixed
+   * again, so the high bits of the words reach the low bits HashIndex picks
+   * its slot with. sets of states with large ids would collide otherwise.
+   */
+  std::size_t hash() const
+  {
+    return HashIndex::combine(HashIndex::hash(ws.begin(), ws.end()), ws.size());
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(ws, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(ws, ws.size());
+  }
+
+private:
+  void trim()
+  {
+    while (!ws.empty() && ws.back() == 0)
+      ws.pop_back();
+  }
+
+  words ws;
+};
+
+
+namespace std {
+  template <>
+  struct hash<Bitset> {
+    std::size_t operator()(const Bitset &b) const
+    {
+      return b.hash();
+    }
+  };
+}
+
+#endif // __BITSET_HPP__
@@ -1,6 +1,7 @@
 #ifndef __COMPAREUTILS_HPP__
 #define __COMPAREUTILS_HPP__
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -11,6 +12,7 @@
 #include "AlignmentUtils.hpp"
 #include "DetGraph.hpp"
 #include "DetWitnessUtils.hpp"
+#include "HashIndex.hpp"
 
 namespace Cmp {
   struct VertexPair {
@@ -25,30 +27,41 @@ namespace Cmp {
     }
   };
 
+  /**
+   * node of the product search. parent is the index of the node this one was
+   * first reached from (npos for the start), so a path is only materialized
+   * when it is asked for.
+   */
   struct Vertex {
     Cmp::VertexPair pair;
-    std::vector<Cmp::VertexPair> path;
+    std::size_t parent;
 
-    Vertex() {}
-    Vertex(DG::vDesc g, DWG::vDesc d) : pair{Cmp::VertexPair(g, d)}{}
+    static const std::size_t npos = SIZE_MAX;
 
-    bool operator==(const Cmp::Vertex &other) const {
-      return (pair == other.pair) && (path == other.path);
-    }
+    Vertex() : parent{npos} {}
+    Vertex(DG::vDesc g, DWG::vDesc d, std::size_t p = npos) : pair{Cmp::VertexPair(g, d)}, parent{p} {}
   };
 
   bool isExitCondition(const Cmp::VertexPair &vp, const DG_t &g, const DWG_t &dwg);
-  bool alreadyVisited(const Cmp::Vertex &p, std::vector<Cmp::Vertex> visited);
 
-  bool isEqual(const DG_t &g, const DWG_t &dwg, const labelGroupingMap &lgm);
+  std::size_t hashPair(const Cmp::VertexPair &vp);
+  std::size_t findVisited(const Cmp::VertexPair &vp, const std::vector<Cmp::Vertex> &visited, const HashIndex &index);
+
+  bool isEqual(const DG_t &g, const DWG_t &dwg);
+  bool isEqualLhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els);
+  bool isEqualRhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els);
+  bool isEqualLhs(const DG_t &g, WG::Builder &wgb, const edgeLabelSet &els);
+  bool isEqualRhs(const DG_t &g, WG::Builder &wgb, const edgeLabelSet &els);
+  bool isIncludedLhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els);
+  bool isIncludedRhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els);
 
-  void inheritPath(Cmp::Vertex &v, const Cmp::Vertex &vpath);
+  std::vector<Cmp::VertexPair> getPath(const std::vector<Cmp::Vertex> &visited, std::size_t i);
 
 
 
 
-  std::string vpToString(const Cmp::VertexPair &vp, const DG_t &g, const DWG_t &dwg);
-  std::string vertexToString(const Cmp::Vertex &v, const DG_t &g, const DWG_t &dwg);
+  std::string vpToString(const Cmp::VertexPair &vp, const DG_t &g);
+  std::string pathToString(const std::vector<Cmp::VertexPair> &path, const DG_t &g);
 
 
 
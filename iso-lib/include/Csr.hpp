@@ -0,0 +1,166 @@
+#ifndef __CSR_HPP__
+#define __CSR_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/range/irange.hpp>
+
+
+/**
+ * Frozen out-edges of a finished graph in compressed sparse row form.
+ *
+ * The out-edges of vertex v are the edge indices firsts[v] .. lasts[v], their
+ * targets and edge data are stored in two contiguous arrays. Edges keep the
+ * order of the adjacency list they were frozen from, so "first matching edge"
+ * lookups give the same result on both forms.
+ *
+ * Vertices keep their descriptors, the vertex properties stay in the graph.
+ * The builders add vertices in breadth-first order from the start already, so
+ * the descriptors are BFS numbers and neighbouring states are close in memory.
+ * The edges of the graph are dropped once it is frozen, see Util::dropEdges,
+ * so they are only stored here.
+ *
+ * A graph that is built on demand adds the out-edges of each vertex with
+ * addRow once they are known, in any vertex order. Vertices without a row
+ * have no out-edges.
+ */
+template <typename E>
+class Csr {
+public:
+  using edgeRange = boost::integer_range<std::size_t>;
+
+  /**
+   * freeze the out-edges of g. data(g, e) gives the edge data stored for e.
+   */
+  template <typename G, typename F>
+  static Csr<E> freeze(const G &g, const F &data)
+  {
+    Csr<E> csr;
+
+    const std::size_t n = boost::num_vertices(g);
+    const std::size_t m = boost::num_edges(g);
+
+    Csr<E>::checkSize(n, m);
+
+    csr.firsts.reserve(n);
+    csr.lasts.reserve(n);
+    csr.targets.reserve(m);
+    csr.datas.reserve(m);
+
+    for (const auto &v : boost::make_iterator_range(boost::vertices(g))) {
+      csr.firsts.push_back(csr.targets.size());
+
+      for (const auto &e : boost::make_iterator_range(boost::out_edges(v, g))) {
+        csr.targets.push_back(boost::target(e, g));
+        csr.datas.push_back(data(e));
+      }
+
+      csr.lasts.push_back(csr.targets.size());
+    }
+
+    return csr;
+  }
+
+  /**
+   * add the out-edges of v, given as (target, data) pairs. v must not have a
+   * row yet.
+   */
+  template <typename R>
+  void addRow(const std::size_t &v, const R &edges)
+  {
+    // rows added after the last one keep the vertex order.
+    if (v >= firsts.size()) {
+      firsts.resize(v + 1, targets.size());
+      lasts.resize(v + 1, targets.size());
+    }
+    else
+      inOrder = inOrder && v + 1 == firsts.size() && firsts[v] == targets.size();
+
+    firsts[v] = targets.size();
+
+    for (const auto &e : edges) {
+      targets.push_back(e.first);
+      datas.push_back(e.second);
+    }
+
+    Csr<E>::checkSize(firsts.size(), targets.size());
+
+    lasts[v] = targets.size();
+  }
+
+  std::size_t numVertices() const
+  {
+    return firsts.size();
+  }
+
+  std::size_t numEdges() const
+  {
+    return targets.size();
+  }
+
+  edgeRange outEdges(const std::size_t &v) const
+  {
+    if (v >= firsts.size())
+      return boost::irange<std::size_t>(0, 0);
+
+    return boost::irange<std::size_t>(firsts[v], lasts[v]);
+  }
+
+  std::size_t outDegree(const std::size_t &v) const
+  {
+    return (v >= firsts.size()) ? 0 : lasts[v] - firsts[v];
+  }
+
+  std::size_t target(const std::size_t &e) const
+  {
+    return targets[e];
+  }
+
+  const E &data(const std::size_t &e) const
+  {
+    return datas[e];
+  }
+
+  /**
+   * source of edge e, only meant for output. a binary search over the rows if
+   * they were added in vertex order, a linear one otherwise.
+   */
+  std::size_t source(const std::size_t &e) const
+  {
+    if (inOrder)
+      return std::upper_bound(firsts.begin(), firsts.end(), e) - firsts.begin() - 1;
+
+    for (std::size_t v = 0; v < firsts.size(); ++v) {
+      if (firsts[v] <= e && e < lasts[v])
+        return v;
+    }
+
+    return SIZE_MAX;
+  }
+
+private:
+  // offsets and targets are stored in 32 bits.
+  static void checkSize(const std::size_t &n, const std::size_t &m)
+  {
+    if (n > UINT32_MAX || m > UINT32_MAX) {
+      std::cout << "[Err] Csr // graph too large, " << n << " vertices and " << m << " edges" << std::endl;
+      exit(1);
+    }
+  }
+
+  std::vector<std::uint32_t> firsts;
+  std::vector<std::uint32_t> lasts;
+  std::vector<std::uint32_t> targets;
+  std::vector<E> datas;
+
+  // true while the rows lie in vertex order, so sources can be searched.
+  bool inOrder = true;
+};
+
+#endif // __CSR_HPP__
@@ -8,23 +8,36 @@
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include "Csr.hpp"
 #include "HelperMaps.hpp"
 #include "GraphUtils.hpp"
+#include "TransitionTable.hpp"
 
 struct dgVerticeProps {
-  std::string name;
-  std::string role;
+  vertexRole role = Role::none;
 
   std::vector<Graph::vDesc> vs;
 };
 
 struct dgEdgeProps {
-  std::string label;
-  std::string lowlink;
+  labelId label;
+  groupingId gp;
 };
 
+// names of the vertices of the source graph, so vertex names can be rendered
+// for output without keeping the source graph around. start vertex and final
+// states are cached by DG::addVertex, the frozen out-edges and the transition
+// table by DG::freeze.
 struct dgGraphProps {
   std::string name;
+
+  std::vector<std::string> srcNames;
+
+  std::size_t start = 0;
+  Bitset finals;
+
+  Csr<dgEdgeProps> csr;
+  TransitionTable delta;
 };
 
 using DG_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
@@ -33,8 +46,7 @@ using DG_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
 namespace DG {
 
   struct Vertex {
-    std::string name;
-    std::string role;
+    vertexRole role = Role::none;
 
     std::vector<Graph::vDesc> vs;
   };
@@ -51,37 +63,44 @@ namespace DG {
   using oeIter = DG_t::out_edge_iterator;
   using oeIterPair = std::pair<oeIter, oeIter>;
 
+  using oeRange = Csr<dgEdgeProps>::edgeRange;
+
+  /**
+   * epsilon-closed successors of a single state of the source graph for one
+   * grouping, and the label of its first edge with that grouping.
+   */
+  struct Successor {
+    groupingId gp;
+    label l;
+    Bitset dsts;
+  };
+
   DG_t determinize(const Graph_t &g, const edgeLabelSet &els);
+  DG_t minimize(const DG_t &dg);
+  void freeze(DG_t &dg);
+
+  std::vector<std::vector<DG::Successor>> getSuccessors(const Graph_t &g, const edgeLabelSet &els);
 
   DG::Vertex createVertex();
-  DG::Vertex createVertex(const std::vector<Graph::vDesc> &vertices, const Graph_t &g);
-  DG::Vertex createVertex(const std::set<Graph::vDesc> &vertices, const Graph_t &g);
+  DG::Vertex createVertex(const Bitset &vertices, const Graph_t &g);
 
   DG::Vertex createStart();
   DG::vDesc getStart(const DG_t &dg);
+  bool isFinalState(const DG_t &dg, const DG::vDesc &v);
 
 
-  bool hasVertex(const DG_t &dg, const DG::Vertex &v);
   DG::vDesc getVertexByName(const DG_t &dg, const std::string &name);
 
-  void addVertexToSet(const Graph::vDesc &gv, DG::Vertex &dg);
-
-  void updateVertexName(DG::Vertex &dgv, const Graph_t &g);
-  void updateVertexName(DG_t &dg, const DG::vDesc &v, const Graph_t &g);
+  std::string getVertexName(const DG_t &dg, const DG::vDesc &v);
 
-  DG::vDesc addEmptyVertex(DG_t &dg, const edgeLabelSet &els);
-  void addSelfEdges(DG_t &dg, const DG::vDesc &v, const edgeLabelSet &els);
 
-  DG::eDesc addEdge(DG_t &dg, const DG::vDesc &src, const label &l, const DG::vDesc &dst);
+  DG::eDesc addEdge(DG_t &dg, const DG::vDesc &src, const label &l, const groupingId &gp, const DG::vDesc &dst);
   DG::vDesc addVertex(DG_t &dg, const DG::Vertex &v);
 
-  std::vector<DG::eDesc> getOutEdges(const DG_t &dg, const DG::vDesc &v, const Graph_t &g);
-  Range<DG::oeIter> getOutEdges(const DG_t &g, const DG::vDesc &v);
+  DG::oeRange getFrozenOutEdges(const DG_t &g, const DG::vDesc &v);
 
-  bool hasEdgeForGrouping(const Graph_t &g, const std::vector<Graph::eDesc> &edges, const alignmentGrouping &gp, label& l);
-  std::vector<Graph::eDesc> getEdgesForGrouping(const Graph_t &g, const std::vector<Graph::eDesc> &edges, const alignmentGrouping &gp);
 
-  DG::vDesc getDst(const DG::vDesc &v, const std::string &l, const DG_t &g);
+  DG::vDesc getDst(const DG::vDesc &v, const groupingId &gp, const DG_t &g);
 
 
 
@@ -92,8 +111,8 @@ namespace DG {
   void printVertices(const DG_t &g);
   void printEdges(const DG_t &g);
 
-  void printOutEdge(const DG_t &g, const Graph::eDesc &e);
-  void printOutEdge(const DG_t &g, const Graph::eDesc &e, std::ostream& target);
+  void printOutEdge(const DG_t &g, const std::size_t &e);
+  void printOutEdge(const DG_t &g, const std::size_t &e, std::ostream& target);
   void printOutEdges(const DG_t &g, const Graph::vDesc &vd);
   void printOutEdges(const DG_t &g, const Graph::vDesc &vd, std::ostream& target);
 }
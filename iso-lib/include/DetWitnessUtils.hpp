@@ -8,25 +8,38 @@
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include "Csr.hpp"
+#include "HashIndex.hpp"
 #include "HelperMaps.hpp"
+#include "TransitionTable.hpp"
 #include "WitnessUtils.hpp"
 #include "Utils.hpp"
 
 
 struct dwgVertexProps {
-  std::string name;
-  std::string role;
+  vertexRole role = Role::none;
 
   std::vector<WG::vDesc> vs;
 };
 
 struct dwgEdgeProps {
-  std::string name;
-  alignmentGrouping gp;
+  groupingId gp;
 };
 
 struct dwgProps {
   std::string name;
+
+  // vertices keyed by their sorted set of witness graph vertices, filled by
+  // the subset construction.
+  HashIndex index;
+
+  std::size_t start = 0;
+  Bitset finals;
+
+  // transition table, filled while the states are expanded, and the frozen
+  // out-edges (edge data is the grouping), built by DWG::freeze.
+  Csr<groupingId> csr;
+  TransitionTable delta;
 };
 
 using DWG_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
@@ -35,8 +48,7 @@ using DWG_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
 
 namespace DWG {
   struct Vertex {
-    std::string name;
-    std::string role;
+    vertexRole role = Role::none;
 
     std::vector<WG::vDesc> vs;
   };
@@ -53,47 +65,82 @@ namespace DWG {
   using oeIter = DWG_t::out_edge_iterator;
   using oeIterPair = std::pair<oeIter, oeIter>;
 
+  // the empty state. it is not stored: a state without an edge for a grouping
+  // moves to it, and it never leaves itself.
+  const DWG::vDesc dead = TransitionTable::npos;
+
+  /**
+   * builder for the subset construction (see SubsetConstruction.hpp) that
+   * determinizes wg on one side. states are sorted sets of wg vertices, closed
+   * under the empty moves of that side.
+   *
+   * the successor for a grouping is the closure of the destinations of its
+   * edges, also when they are all in the current state already: the state may
+   * accept more than its successor, so a self-edge would accept words that wg
+   * does not have. groupings without an edge get no edge, they lead to
+   * DWG::dead.
+   *
+   * the witness graph is read through source, a WG::Frozen or WG::OnDemand of
+   * the same side. instantiated for WG::Lhs and WG::Rhs and both sources.
+   */
+  template <typename Side, typename Source = WG::Frozen<Side>>
+  class Builder {
+  public:
+    using set_t  = std::vector<WG::vDesc>;
+    using edge_t = groupingId;
+
+    Builder(DWG_t &dwg, Source &source, const edgeLabelSet &els);
+
+    set_t start() const;
+    std::size_t add(const set_t &s, const bool &isStart);
+    const set_t &get(const std::size_t &v) const;
+    std::size_t hash(const set_t &s) const;
+    HashIndex &index();
+
+    void expand(const std::size_t &v, std::vector<std::pair<edge_t, set_t>> &succs);
+    void addEdge(const std::size_t &v, const edge_t &gp, const std::size_t &dst);
+
+  private:
+    DWG_t &dwg;
+    Source &source;
+
+    // out-edges of the current state by grouping, reused for every state.
+    const std::size_t width;
+    std::vector<bool> inEls;
+    WG::Buckets buckets;
+  };
+
   DWG_t createLhs(const WG_t &wg, const edgeLabelSet &els);
   DWG_t createRhs(const WG_t &wg, const edgeLabelSet &els);
+  void freeze(DWG_t &dwg);
 
   DWG::Vertex createVertex();
-  DWG::Vertex createVertex(const std::string &name, const std::string &role);
+  DWG::Vertex createVertex(const vertexRole &role);
 
-  void addVertexToSet(DWG::Vertex &dwgv, const WG::vDesc wgv, const WG_t &wg);
-  void addVertexToSet(DWG_t &dwg, DWG::vDesc &dwgv, const WG::vDesc wgv, const WG_t &wg);
+  void addVertexToSet(DWG::Vertex &dwgv, const WG::vDesc wgv);
 
-  void updateVertexName(DWG::Vertex &dwgv, const WG_t &wg);
-  void updateVertexName(const DWG::vDesc &dwgv, DWG_t &dwg, const WG_t &wg);
+  std::string getVertexName(const DWG_t &dwg, const DWG::vDesc &v, const WG_t &wg, const DG_t &g1, const DG_t &g2);
 
-  DWG::vDesc addVertex(DWG_t &dwg, const DWG::Vertex &v, const WG_t &wg);
-  DWG::vDesc addEmptyVertex(DWG_t &dwg, const edgeLabelSet &els);
+  DWG::vDesc addVertex(DWG_t &dwg, const DWG::Vertex &v);
 
-  DWG::eDesc addEdge(DWG::vDesc &v1, const alignmentGrouping &gp, DWG::vDesc &v2, DWG_t &dwg);
+  DWG::eDesc addEdge(DWG::vDesc &v1, const groupingId &gp, DWG::vDesc &v2, DWG_t &dwg);
 
   DWG::Vertex getVertex(const DWG::vDesc &v, const DWG_t &dwg);
-  DWG::vDesc  getVertex(const DWG::Vertex &v, const DWG_t &dwg);
+  DWG::vDesc  findVertex(const DWG::Vertex &v, const DWG_t &dwg);
+
+  const std::vector<WG::vDesc> &getVertexSet(const DWG::vDesc &v, const DWG_t &dwg);
+  std::size_t hashVertexSet(const std::vector<WG::vDesc> &vs);
 
   DWG::vDesc getStart(const DWG_t &dwg);
-  DWG::vDesc getDst(const DWG::vDesc &v, const alignmentGrouping &gp, const DWG_t &dwg);
+  bool isFinalState(const DWG_t &dwg, const DWG::vDesc &v);
+  DWG::vDesc getDst(const DWG::vDesc &v, const groupingId &gp, const DWG_t &dwg);
 
-  std::vector<WG::eDesc> getOutEdges(const DWG::Vertex &v, const WG_t &wg);
-  std::vector<WG::eDesc> getOutEdges(const DWG_t & dwg, const WG_t &wg, const DWG::vDesc &v);
+  std::vector<WG::eIndex> getOutEdges(const DWG::Vertex &v, const WG_t &wg);
+  std::vector<WG::eIndex> getOutEdges(const DWG_t & dwg, const WG_t &wg, const DWG::vDesc &v);
 
   bool hasVertex(const DWG::Vertex &v, const DWG_t &dwg);
   bool vertexHasVertex(const DWG::Vertex &dwgv, const WG::vDesc &wgv);
 
-  bool hasVertexThatContains(const WG::vDesc &v, const DWG_t &dwg);
-
-  DWG::vDesc getVertexThatContains(const WG::vDesc &wgv, const DWG_t &dwg);
-
-  bool alreadyVisited(const std::vector<WG::vDesc> &vs, const WG::vDesc &t);
-  bool alreadyContained(const DWG::Vertex &v, const WG::vDesc &nv);
-  bool destinationsAreSubset(const std::vector<WG::vDesc> dsts, const DWG::Vertex &v);
-
-  void findAllNodesLhs(DWG::Vertex &v, const WG_t &wg);
-  void findAllNodesRhs(DWG::Vertex &v, const WG_t &wg);
-
-
   void setFinalState(DWG::Vertex &v, const WG_t &wg);
 
 
@@ -101,9 +148,9 @@ namespace DWG {
 
 
 
-  void print(const DWG_t &dwg);
-  void printOutEdges(const DWG::vDesc &v, const DWG_t &dwg);
-  void printOutEdge(const DWG::eDesc &e, const DWG_t &dwg);
+  void print(const DWG_t &dwg, const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt);
+  void printOutEdges(const DWG::vDesc &v, const DWG_t &dwg, const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt);
+  void printOutEdge(const std::size_t &e, const DWG_t &dwg, const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt);
 
 
 }
@@ -10,24 +10,28 @@
 #include <boost/range/iterator_range.hpp>
 
 #include "AlignmentUtils.hpp"
+#include "Bitset.hpp"
+#include "RoleUtils.hpp"
 #include "Utils.hpp"
 
 
 
 struct VerticeProps {
   std::string name;
-  std::string role;
+  vertexRole role = Role::none;
 };
 
 struct EdgeProps {
-  std::string label;
-  alignmentGrouping gp;
-
-  std::string lowlink;
+  labelId label;
+  groupingId gp;
 };
 
+// start vertex and final states, cached by Graph::parse.
 struct GraphProps {
   std::string name;
+
+  std::size_t start = 0;
+  Bitset finals;
 };
 
 using Graph_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
@@ -60,27 +64,24 @@ namespace Graph {
   std::vector<Graph::eDesc> getOutEdgesVec(const Graph_t &g, const Graph::vDesc &v);
 
   Graph::vDesc getVertex(const std::string &vName, const Graph_t &g);
-  Graph::vDesc getDst(const Graph::vDesc &v, const std::string &l, const Graph_t &g);
-  
-  /**
-   * @deprecated in favor of Graph::getDestinationsWithEpsilonClosure
-   */
-  std::set<Graph::vDesc> getDestinations(const Graph_t &g, std::vector<Graph::eDesc> edges);
-  
-  std::set<Graph::vDesc> getDestinationsWithEpsilonClosure(const Graph_t &g, std::vector<Graph::eDesc> edges);
+  Graph::vDesc getDst(const Graph::vDesc &v, const label &l, const Graph_t &g);
+
+  std::vector<Bitset> getEpsilonClosures(const Graph_t &g);
+  Graph_t reduce(const Graph_t &g);
+  Graph_t trim(const Graph_t &g);
 
 
 
 
 
 
-  void print(const Graph_t &g);
+  void print(const Graph_t &g, const groupingTable &gt);
 
   void printVertices(const Graph_t &g);
   void printEdges(const Graph_t &g);
 
-  void printOutEdge(const Graph_t &g, const Graph::eDesc &e);
-  void printOutEdges(const Graph_t &g, const Graph::vDesc &vd);
+  void printOutEdge(const Graph_t &g, const Graph::eDesc &e, const groupingTable &gt);
+  void printOutEdges(const Graph_t &g, const Graph::vDesc &vd, const groupingTable &gt);
 
 
 }
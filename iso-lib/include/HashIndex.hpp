@@ -0,0 +1,134 @@
+#ifndef __HASHINDEX_HPP__
+#define __HASHINDEX_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * Open-addressing hash index from keys to vertex descriptors (or any other
+ * dense ids).
+ *
+ * The index does not store the keys themselves, only their precomputed hash
+ * and the id they belong to. The keys already live in the graph properties, so
+ * find() takes a predicate that compares the key of a candidate id with the
+ * one being looked up. It is only called for slots with a matching hash.
+ *
+ * Ids are never removed. Linear probing, the table is kept at most half full.
+ */
+class HashIndex {
+public:
+  static const std::size_t npos = SIZE_MAX;
+
+  HashIndex() : slots(16), used(0) {}
+
+  /**
+   * id of the key with hash h for which eq(id) holds, or npos.
+   */
+  template <typename Eq>
+  std::size_t find(const std::size_t &h, const Eq &eq) const
+  {
+    const std::size_t mask = slots.size() - 1;
+
+    for (std::size_t i = h & mask; slots[i].id != npos; i = (i + 1) & mask) {
+      if (slots[i].hash == h && eq(slots[i].id))
+        return slots[i].id;
+    }
+
+    return npos;
+  }
+
+  /**
+   * add id under hash h. the key must not be contained yet.
+   */
+  void insert(const std::size_t &h, const std::size_t &id)
+  {
+    if (2 * (used + 1) > slots.size())
+      grow();
+
+    place(h, id);
+    ++used;
+  }
+
+  std::size_t size() const
+  {
+    return used;
+  }
+
+  /**
+   * remove all ids. the table keeps its size, so refilling it does not grow.
+   */
+  void clear()
+  {
+    std::fill(slots.begin(), slots.end(), slot());
+    used = 0;
+  }
+
+  /**
+   * hash of a sequence of integral values, e.g. a sorted state set.
+   */
+  template <typename It>
+  static std::size_t hash(It begin, It end)
+  {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+
+    for (; begin != end; ++begin)
+      h = (h ^ mix(*begin)) * 0x100000001b3ull;
+
+    return mix(h);
+  }
+
+  static std::size_t combine(const std::size_t &h, const std::uint64_t &v)
+  {
+    return mix((h ^ mix(v)) * 0x100000001b3ull);
+  }
+
+private:
+  struct slot {
+    std::size_t hash;
+    std::size_t id;
+
+    slot() : hash(0), id(npos) {}
+  };
+
+  static std::uint64_t mix(std::uint64_t x)
+  {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+
+    return x;
+  }
+
+  void place(const std::size_t &h, const std::size_t &id)
+  {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t i = h & mask;
+
+    while (slots[i].id != npos)
+      i = (i + 1) & mask;
+
+    slots[i].hash = h;
+    slots[i].id   = id;
+  }
+
+  void grow()
+  {
+    std::vector<slot> old(2 * slots.size());
+    old.swap(slots);
+
+    for (const slot &s : old) {
+      if (s.id != npos)
+        place(s.hash, s.id);
+    }
+  }
+
+  std::vector<slot> slots;
+  std::size_t used;
+};
+
+#endif // __HASHINDEX_HPP__
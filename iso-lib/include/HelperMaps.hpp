@@ -10,21 +10,21 @@
 #include "Utils.hpp"
 
 
-using labelGroupingMap = std::unordered_map<label, alignmentGrouping>;
+using labelGroupingMap = std::unordered_map<label, groupingId>;
 using labelAlmSubMap = std::unordered_map<label, alignmentSub>;
 
-using edgeLabelSet = std::set<alignmentGrouping>;
+using edgeLabelSet = std::set<groupingId>;
 
 using labelPermissivenessMap = std::unordered_map<label, int>;
 
 
 
 namespace Helper {
-  labelGroupingMap LabelGroupingMap(const Graph_t &g, const alignmentHalf &alh);
+  labelGroupingMap LabelGroupingMap(const Graph_t &g, const alignmentHalf &alh, groupingTable &gt);
   labelAlmSubMap LabelAlmSubMap(const Graph_t &g, const alignment &alm);
 
   edgeLabelSet lgmFlatten(const labelGroupingMap &lgm);
-  std::vector<label> elsFlatten(const edgeLabelSet &els);
+  std::vector<label> elsFlatten(const edgeLabelSet &els, const groupingTable &gt);
 
   void labelsToGroupings(Graph_t &g, labelGroupingMap &lgm);
 
@@ -38,9 +38,9 @@ namespace Helper {
 
 
 
-  void printLgm(const labelGroupingMap &lgm);
+  void printLgm(const labelGroupingMap &lgm, const groupingTable &gt);
   void printLsm(const labelAlmSubMap &lsm);
-  void printEls(const edgeLabelSet &els);
+  void printEls(const edgeLabelSet &els, const groupingTable &gt);
   void printLpm(const labelPermissivenessMap &lpm);
 }
 
@@ -0,0 +1,31 @@
+#ifndef __LABELUTILS_HPP__
+#define __LABELUTILS_HPP__
+
+#include <cstdint>
+#include <string>
+
+
+/**
+ * Dense integer id of a label. Ids are handed out in the order in which the
+ * labels are first seen, so they can be used directly as vector indices.
+ */
+using labelId = std::uint32_t;
+
+
+/**
+ * Process-wide symbol table for labels. Both models and the alignment intern
+ * their labels here while parsing, so the same label string always maps to the
+ * same id and all comparisons in iso-lib are integer compares. The string is
+ * only looked up again for output.
+ *
+ * The table is append-only, so it may be used from the worker threads of
+ * iso-search: interning takes a mutex, looking up a name does not.
+ */
+namespace Lbl {
+  labelId intern(const std::string &name);
+  const std::string &name(const labelId &l);
+
+  std::size_t count();
+}
+
+#endif // __LABELUTILS_HPP__
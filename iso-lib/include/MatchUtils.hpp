@@ -1,37 +1,67 @@
 #ifndef __MATCHUTILS_HPP__
 #define __MATCHUTILS_HPP__
 
+#include <unordered_map>
+#include <vector>
+
 #include "AlignmentUtils.hpp"
+#include "Bitset.hpp"
 #include "Utils.hpp"
 
 
+// a match set is a subset of the alignment, stored as a bitset over the indices
+// of its pairs in the alignment. it is only meaningful together with that
+// alignment.
 using match             = alignmentPair;
-using matchSet          = alignment;
+using matchSet          = Bitset;
+
+
+/**
+ * Id of an interned match set. Witness graph vertices carry match set ids, so
+ * comparing match sets is an integer compare. Id 0 is reserved for the empty
+ * match set.
+ */
+using matchSetId = std::uint32_t;
+
+const matchSetId emptyMatchSet = 0;
+
+/**
+ * Hash-consing table for match sets. Every witness graph owns one, since the
+ * pair indices depend on the alignment it was built from.
+ */
+struct matchSetTable {
+  std::vector<matchSet> sets;
+  std::unordered_map<matchSet, matchSetId> ids;
+
+  matchSetTable() : sets{matchSet()}, ids{{matchSet(), emptyMatchSet}} {}
+};
 
 
 namespace Match {
 
 
   bool hasLabel(const match &m, const label &l);
-  bool setHasMatch(const matchSet &ms, const match &m);
-  bool hasMatchWithBothGroupsDifferentThan(const matchSet &matchSet, const match &match);
+  bool setHasMatch(const matchSet &ms, const std::size_t &i);
+  bool hasMatchWithBothGroupsDifferentThan(const alignment &alm, const matchSet &ms, const match &m);
 
   bool empty(const match &m);
 
   std::string toString(const match &m);
-  std::string setToString(const matchSet &m);
-
+  std::string setToString(const alignment &alm, const matchSet &ms);
 
-  matchSet getMatchSet(const alignment &alm, const matchSet &ms, const label &l1, const label &l2);
 
-  matchSet getMatchSet2(const matchSet &ms, const label &l);
+  matchSet getMatchSet(const alignment &alm, const alignmentIndex &idx, const matchSet &ms,
+                       const label &l1, const label &l2);
 
+  matchSet getMatchSet2(const alignmentIndex &idx, const matchSet &ms, const label &l);
 
+  matchSetId intern(matchSetTable &mst, const matchSet &ms);
+  const matchSet &lookup(const matchSetTable &mst, const matchSetId &id);
 
 
 
   void print(const match &m);
-  void printSet(const matchSet &ms);
+  void printSet(const alignment &alm, const matchSet &ms);
 
 
 
@@ -0,0 +1,142 @@
+#ifndef __PARTITION_HPP__
+#define __PARTITION_HPP__
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/**
+ * Refinable partition of the elements 0 .. n-1, the core of partition
+ * refinement algorithms like Hopcroft's.
+ *
+ * The members of a block are a contiguous range of one permutation of the
+ * elements, so a block is split in place: elements are marked by moving them
+ * to the front of their block, and split() turns the marked front of every
+ * touched block into a new block. Block ids are dense and never reused.
+ */
+class Partition {
+public:
+  /**
+   * initial partition given by the block of every element, block ids are
+   * 0 .. count-1 and every block must be non-empty.
+   */
+  Partition(const std::vector<std::size_t> &blocks, const std::size_t &count)
+    : elems(blocks.size()), loc(blocks.size()), blk(blocks),
+      first(count + 1, 0), mid(count), last(count)
+  {
+    for (const std::size_t &b : blocks)
+      ++first[b + 1];
+
+    for (std::size_t b = 0; b < count; ++b)
+      first[b + 1] += first[b];
+
+    first.pop_back();
+
+    std::vector<std::size_t> pos(first);
+
+    for (std::size_t e = 0; e < blocks.size(); ++e) {
+      loc[e] = pos[blocks[e]]++;
+      elems[loc[e]] = e;
+    }
+
+    for (std::size_t b = 0; b < count; ++b)
+      mid[b] = first[b];
+
+    last = pos;
+  }
+
+  std::size_t count() const
+  {
+    return first.size();
+  }
+
+  std::size_t blockOf(const std::size_t &e) const
+  {
+    return blk[e];
+  }
+
+  std::size_t size(const std::size_t &b) const
+  {
+    return last[b] - first[b];
+  }
+
+  /**
+   * the members of block b, in no particular order.
+   */
+  std::vector<std::size_t>::const_iterator begin(const std::size_t &b) const
+  {
+    return elems.begin() + first[b];
+  }
+
+  std::vector<std::size_t>::const_iterator end(const std::size_t &b) const
+  {
+    return elems.begin() + last[b];
+  }
+
+  void mark(const std::size_t &e)
+  {
+    const std::size_t b = blk[e];
+    const std::size_t i = loc[e];
+
+    if (i < mid[b])
+      return;
+
+    if (mid[b] == first[b])
+      touched.push_back(b);
+
+    std::swap(elems[i], elems[mid[b]]);
+    loc[elems[i]] = i;
+    loc[elems[mid[b]]] = mid[b];
+
+    ++mid[b];
+  }
+
+  /**
+   * split the marked elements off every block that is only partly marked and
+   * clear all marks. split(b, nb) is called for each new block nb, which holds
+   * the elements that were marked in b.
+   */
+  template <typename F>
+  void split(const F &f)
+  {
+    for (const std::size_t &b : touched) {
+      if (mid[b] == last[b]) {
+        mid[b] = first[b];
+        continue;
+      }
+
+      const std::size_t nb = first.size();
+
+      first.push_back(first[b]);
+      mid.push_back(first[b]);
+      last.push_back(mid[b]);
+
+      first[b] = mid[b];
+
+      for (std::size_t i = first[nb]; i < last[nb]; ++i)
+        blk[elems[i]] = nb;
+
+      f(b, nb);
+    }
+
+    touched.clear();
+  }
+
+private:
+  // the elements block by block, and the position of each element in it.
+  std::vector<std::size_t> elems;
+  std::vector<std::size_t> loc;
+
+  std::vector<std::size_t> blk;
+
+  // block b is elems[first[b]] .. elems[last[b]-1], its marked elements are
+  // the ones before mid[b].
+  std::vector<std::size_t> first;
+  std::vector<std::size_t> mid;
+  std::vector<std::size_t> last;
+
+  std::vector<std::size_t> touched;
+};
+
+#endif // __PARTITION_HPP__
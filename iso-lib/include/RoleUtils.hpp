@@ -0,0 +1,31 @@
+#ifndef __ROLEUTILS_HPP__
+#define __ROLEUTILS_HPP__
+
+#include <cstdint>
+#include <string>
+
+
+/**
+ * Role of a vertex as bit flags. The input models carry it as the "role"
+ * attribute, the constructed graphs derive it from the vertices they are built
+ * from. Tests are plain bit tests, the strings are only used for reading and
+ * writing dot files.
+ */
+using vertexRole = std::uint8_t;
+
+namespace Role {
+  const vertexRole none  = 0;
+  const vertexRole start = 1 << 0;
+  const vertexRole end   = 1 << 1;
+  const vertexRole empty = 1 << 2;
+
+  vertexRole parse(const std::string &s);
+  std::string toString(const vertexRole &r);
+
+  inline bool has(const vertexRole &r, const vertexRole &flag)
+  {
+    return (r & flag) != 0;
+  }
+}
+
+#endif // __ROLEUTILS_HPP__
@@ -0,0 +1,123 @@
+#ifndef __SCC_HPP__
+#define __SCC_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * Strongly connected components of a graph given as adjacency arrays: the
+ * successors of vertex v are targets[offsets[v]] .. targets[offsets[v+1]-1].
+ *
+ * Iterative version of Tarjan's algorithm, so long chains do not overflow the
+ * call stack. Components are numbered in the order Tarjan completes them,
+ * which is reverse topological: an edge between two components always goes
+ * to the one with the smaller number. Closures can thus be built in a single
+ * pass over the components in ascending order.
+ */
+namespace Scc {
+
+  struct Components {
+    std::size_t count = 0;
+
+    // component of every vertex.
+    std::vector<std::size_t> of;
+
+    // members of component c, ascending: members[memberOffsets[c]] ..
+    // members[memberOffsets[c+1]-1].
+    std::vector<std::size_t> memberOffsets;
+    std::vector<std::size_t> members;
+  };
+
+  inline Scc::Components find(const std::vector<std::size_t> &offsets, const std::vector<std::size_t> &targets)
+  {
+    const std::size_t n = offsets.size() - 1;
+    const std::size_t unvisited = SIZE_MAX;
+
+    Scc::Components res;
+    res.of.assign(n, unvisited);
+
+    std::vector<std::size_t> index(n, unvisited);
+    std::vector<std::size_t> lowlink(n, 0);
+    std::vector<bool> onStack(n, false);
+
+    std::vector<std::size_t> stack;
+
+    // dfs frames: vertex and position of the next successor to look at.
+    std::vector<std::pair<std::size_t, std::size_t>> dfs;
+
+    std::size_t counter = 0;
+
+    for (std::size_t root = 0; root < n; ++root) {
+      if (index[root] != unvisited)
+        continue;
+
+      index[root] = lowlink[root] = counter++;
+      stack.push_back(root);
+      onStack[root] = true;
+      dfs.push_back(std::make_pair(root, offsets[root]));
+
+      while (!dfs.empty()) {
+        const std::size_t v = dfs.back().first;
+        std::size_t &next = dfs.back().second;
+
+        if (next != offsets[v + 1]) {
+          const std::size_t w = targets[next++];
+
+          if (index[w] == unvisited) {
+            index[w] = lowlink[w] = counter++;
+            stack.push_back(w);
+            onStack[w] = true;
+            dfs.push_back(std::make_pair(w, offsets[w]));
+          }
+          else if (onStack[w]) {
+            lowlink[v] = std::min(lowlink[v], index[w]);
+          }
+
+          continue;
+        }
+
+        dfs.pop_back();
+
+        if (!dfs.empty())
+          lowlink[dfs.back().first] = std::min(lowlink[dfs.back().first], lowlink[v]);
+
+        if (lowlink[v] != index[v])
+          continue;
+
+        // v is the root of a component, its members are on top of the stack.
+        std::size_t w;
+
+        do {
+          w = stack.back();
+          stack.pop_back();
+          onStack[w] = false;
+          res.of[w] = res.count;
+        } while (w != v);
+
+        ++res.count;
+      }
+    }
+
+    // group the vertices by component, ascending within each.
+    res.memberOffsets.assign(res.count + 1, 0);
+
+    for (std::size_t v = 0; v < n; ++v)
+      ++res.memberOffsets[res.of[v] + 1];
+
+    for (std::size_t c = 0; c < res.count; ++c)
+      res.memberOffsets[c + 1] += res.memberOffsets[c];
+
+    std::vector<std::size_t> pos(res.memberOffsets.begin(), res.memberOffsets.end() - 1);
+    res.members.resize(n);
+
+    for (std::size_t v = 0; v < n; ++v)
+      res.members[pos[res.of[v]]++] = v;
+
+    return res;
+  }
+}
+
+#endif // __SCC_HPP__
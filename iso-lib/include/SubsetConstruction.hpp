@@ -0,0 +1,117 @@
+#ifndef __SUBSETCONSTRUCTION_HPP__
+#define __SUBSETCONSTRUCTION_HPP__
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "HashIndex.hpp"
+
+
+/**
+ * Worklist subset construction shared by DG::determinize and
+ * DWG::createLhs/Rhs, and the on-demand variant behind Cmp::isEqualLhs/Rhs.
+ *
+ * The engine owns the lookup of state sets, everything else is up to the
+ * builder B, which fixes the source graph, the side and the closure policy at
+ * compile time:
+ *
+ *   set_t                        closed state set, compared with ==
+ *   edge_t                       data of an edge of the target graph
+ *   set_t start()                state set of the start state
+ *   std::size_t add(s, isStart)  add a target state for the set s
+ *   const set_t &get(v)          state set of target state v
+ *   std::size_t hash(s)          hash of a state set
+ *   HashIndex &index()           target states keyed by the hash of their set
+ *   void expand(v, succs)        append (e, dsts) to succs for each edge e of v
+ *                                that leads to the subset state dsts. edges
+ *                                with a fixed target are added by expand.
+ *   void addEdge(v, e, dst)      add edge e from v to dst
+ */
+namespace Subset {
+
+  /**
+   * subset construction that expands a state only when asked to, so a search
+   * over the target graph can stop before all of it is built.
+   */
+  template <typename B>
+  class Lazy {
+  public:
+    explicit Lazy(B &b) : b(b)
+    {
+      const typename B::set_t s = b.start();
+
+      v0 = b.add(s, true);
+      b.index().insert(b.hash(s), v0);
+    }
+
+    std::size_t start() const
+    {
+      return v0;
+    }
+
+    /**
+     * add the out-edges of v and the states they lead to, unless that was
+     * done before. found(dst) is called for every state that is new.
+     */
+    template <typename F>
+    void expand(const std::size_t &v, const F &found)
+    {
+      if (v >= expanded.size())
+        expanded.resize(v + 1, false);
+
+      if (expanded[v])
+        return;
+
+      expanded[v] = true;
+
+      succs.clear();
+      b.expand(v, succs);
+
+      for (const std::pair<typename B::edge_t, typename B::set_t> &sc : succs) {
+        const std::size_t h = b.hash(sc.second);
+        std::size_t dst = b.index().find(h, [&](const std::size_t &w) { return b.get(w) == sc.second; });
+
+        if (dst == HashIndex::npos) {
+          dst = b.add(sc.second, false);
+          b.index().insert(h, dst);
+          found(dst);
+        }
+
+        b.addEdge(v, sc.first, dst);
+      }
+    }
+
+  private:
+    B &b;
+    std::size_t v0;
+
+    std::vector<bool> expanded;
+
+    // successors of the state being expanded, reused.
+    std::vector<std::pair<typename B::edge_t, typename B::set_t>> succs;
+  };
+
+  /**
+   * the whole target graph. states are numbered in the order they are found,
+   * i.e. breadth-first from the start state.
+   */
+  template <typename B>
+  void construct(B &b)
+  {
+    Subset::Lazy<B> lazy(b);
+
+    std::deque<std::size_t> todo;
+    todo.push_back(lazy.start());
+
+    while (!todo.empty()) {
+      const std::size_t v = todo.front();
+      todo.pop_front();
+
+      lazy.expand(v, [&](const std::size_t &dst) { todo.push_back(dst); });
+    }
+  }
+}
+
+#endif // __SUBSETCONSTRUCTION_HPP__
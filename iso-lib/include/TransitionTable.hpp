@@ -0,0 +1,157 @@
+#ifndef __TRANSITIONTABLE_HPP__
+#define __TRANSITIONTABLE_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Csr.hpp"
+
+
+/**
+ * Transition function state x groupingId -> state of a deterministic graph.
+ *
+ * While the grouping alphabet is small, the table is a dense
+ * numVertices x width array and a lookup is a single index. Larger alphabets
+ * get one sorted (grouping, dst) row per state instead, which is searched
+ * binary.
+ *
+ * If a state has several edges for a grouping, the first one in edge order
+ * wins, same as a linear scan over the out-edges.
+ *
+ * The table is either built from a frozen graph, or filled with add while a
+ * graph is built on demand.
+ */
+class TransitionTable {
+public:
+  static const std::size_t npos = SIZE_MAX;
+
+  // widest grouping alphabet that is still stored densely.
+  static const std::size_t maxDenseWidth = 64;
+
+  TransitionTable() = default;
+
+  /**
+   * empty table for the groupings below width.
+   */
+  explicit TransitionTable(const std::size_t &width) : dense(width <= maxDenseWidth), width(width)
+  {
+  }
+
+  /**
+   * table of the graph frozen in csr. key(d) gives the grouping of an edge
+   * with edge data d.
+   */
+  template <typename E, typename F>
+  static TransitionTable build(const Csr<E> &csr, const F &key)
+  {
+    const std::size_t n = csr.numVertices();
+    std::size_t width = 0;
+
+    for (std::size_t v = 0; v < n; ++v) {
+      for (const std::size_t &e : csr.outEdges(v))
+        width = std::max<std::size_t>(width, key(csr.data(e)) + 1);
+    }
+
+    TransitionTable t(width);
+
+    for (std::size_t v = 0; v < n; ++v) {
+      for (const std::size_t &e : csr.outEdges(v))
+        t.add(v, key(csr.data(e)), csr.target(e));
+    }
+
+    return t;
+  }
+
+  /**
+   * add the edge from v to dst for grouping gp, unless v has one for gp
+   * already. the edges of a state have to be added one after the other,
+   * groupings of width or above are dropped.
+   */
+  void add(const std::size_t &v, const std::size_t &gp, const std::size_t &dst)
+  {
+    if (gp >= width)
+      return;
+
+    if (dense) {
+      if (cells.size() < (v + 1) * width)
+        cells.resize((v + 1) * width, std::uint32_t(none));
+
+      std::uint32_t &cell = cells[v * width + gp];
+
+      if (cell == none)
+        cell = dst;
+
+      return;
+    }
+
+    if (v >= firsts.size()) {
+      firsts.resize(v + 1, rows.size());
+      lasts.resize(v + 1, rows.size());
+    }
+
+    if (firsts[v] == lasts[v])
+      firsts[v] = lasts[v] = rows.size();
+
+    const std::vector<cell_t>::iterator first = rows.begin() + firsts[v];
+
+    const std::vector<cell_t>::iterator it = std::lower_bound(first, rows.end(), gp, [](const cell_t &c, const std::size_t &k) {
+      return c.first < k;
+    });
+
+    if (it != rows.end() && it->first == gp)
+      return;
+
+    rows.insert(it, std::make_pair(std::uint32_t(gp), std::uint32_t(dst)));
+    ++lasts[v];
+  }
+
+  /**
+   * destination of v for grouping gp, or npos if v has no such edge.
+   */
+  std::size_t dst(const std::size_t &v, const std::size_t &gp) const
+  {
+    if (gp >= width)
+      return npos;
+
+    if (dense) {
+      if (v * width + gp >= cells.size())
+        return npos;
+
+      const std::uint32_t d = cells[v * width + gp];
+
+      return (d == none) ? npos : d;
+    }
+
+    if (v >= firsts.size())
+      return npos;
+
+    const std::vector<cell_t>::const_iterator first = rows.begin() + firsts[v];
+    const std::vector<cell_t>::const_iterator last  = rows.begin() + lasts[v];
+
+    const std::vector<cell_t>::const_iterator it = std::lower_bound(first, last, gp, [](const cell_t &c, const std::size_t &k) {
+      return c.first < k;
+    });
+
+    return (it != last && it->first == gp) ? it->second : npos;
+  }
+
+private:
+  using cell_t = std::pair<std::uint32_t, std::uint32_t>;
+
+  static const std::uint32_t none = UINT32_MAX;
+
+  bool dense = true;
+  std::size_t width = 0;
+
+  std::vector<std::uint32_t> cells;
+
+  // the row of state v is rows[firsts[v]] .. rows[lasts[v]-1].
+  std::vector<std::uint32_t> firsts;
+  std::vector<std::uint32_t> lasts;
+  std::vector<cell_t> rows;
+};
+
+#endif // __TRANSITIONTABLE_HPP__
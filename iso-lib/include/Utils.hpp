@@ -1,9 +1,16 @@
 #ifndef __UTILS_HPP__
 #define __UTILS_HPP__
 
+#include <cstddef>
 #include <utility>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include "Bitset.hpp"
+#include "Csr.hpp"
+
 
 template <typename T>
 using Range = boost::iterator_range<T>;
@@ -16,6 +23,56 @@ namespace Util {
     return boost::make_iterator_range(p);
   }
 
+  std::vector<bool> getCoReachable(const std::vector<std::vector<std::size_t>> &preds, const Bitset &targets);
+
+  /**
+   * the vertices of g that can reach one of the vertices in targets, targets
+   * included. g must have dense vertex descriptors.
+   */
+  template <typename G>
+  std::vector<bool> getCoReachable(const G &g, const Bitset &targets)
+  {
+    std::vector<std::vector<std::size_t>> preds(boost::num_vertices(g));
+
+    for (const auto &e : Util::makeRange(boost::edges(g)))
+      preds[boost::target(e, g)].push_back(boost::source(e, g));
+
+    return Util::getCoReachable(preds, targets);
+  }
+
+  /**
+   * same as above for the frozen out-edges of a graph.
+   */
+  template <typename E>
+  std::vector<bool> getCoReachable(const Csr<E> &csr, const Bitset &targets)
+  {
+    std::vector<std::vector<std::size_t>> preds(csr.numVertices());
+
+    for (std::size_t v = 0; v < csr.numVertices(); ++v) {
+      for (const std::size_t &e : csr.outEdges(v))
+        preds[csr.target(e)].push_back(v);
+    }
+
+    return Util::getCoReachable(preds, targets);
+  }
+
+  /**
+   * remove the edges of a frozen graph, so they are not kept twice. the
+   * vertices and all properties stay, the out-edge lists are released.
+   */
+  template <typename G>
+  void dropEdges(G &g)
+  {
+    G res(boost::num_vertices(g));
+
+    for (const auto &v : Util::makeRange(boost::vertices(g)))
+      res[v] = std::move(g[v]);
+
+    res[boost::graph_bundle] = std::move(g[boost::graph_bundle]);
+
+    g.swap(res);
+  }
+
   void printLine();
   void printLineFile(std::ostream& target);
   void printLineDebug();
@@ -1,7 +1,9 @@
 #ifndef __WITNESSUTILS_HPP__
 #define __WITNESSUTILS_HPP__
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/graph/graphviz.hpp>
@@ -9,45 +11,56 @@
 #include <boost/range/iterator_range.hpp>
 
 #include "AlignmentUtils.hpp"
+#include "Csr.hpp"
 #include "DetGraph.hpp"
+#include "HashIndex.hpp"
 #include "HelperMaps.hpp"
 #include "MatchUtils.hpp"
 #include "Utils.hpp"
 
 
 struct wgVertexProps {
-  std::string name;
-  std::string v1Name;
-  std::string v2Name;
-  matchSet ms;
+  DG::vDesc v1;
+  DG::vDesc v2;
+  matchSetId ms;
 
-  std::string role;
+  vertexRole role = Role::none;
 };
 
 struct wgEdgeProps {
-  std::string name;
-
-  alignmentGrouping gp1;
-  alignmentGrouping gp2;
+  groupingId gp1;
+  groupingId gp2;
 };
 
+// the alignment is kept with the graph, since the match sets of its vertices
+// are only meaningful together with it. the out-edges of a vertex are stored
+// in csr once the vertex is expanded, see WG::Builder.
 struct wgProps {
   std::string name;
+
+  alignment alm;
+  alignmentIndex almIndex;
+  matchSetTable mst;
+
+  // vertices keyed by (v1, v2, ms).
+  HashIndex index;
+
+  std::size_t start = 0;
+  Bitset finals;
+
+  Csr<wgEdgeProps> csr;
 };
 
 using WG_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
                                     wgVertexProps, wgEdgeProps, wgProps>;
 
-using vName = std::string;
-
 namespace WG {
   struct Vertex {
-    std::string name;
-    std::string v1Name;
-    std::string v2Name;
-    matchSet ms;
+    DG::vDesc v1;
+    DG::vDesc v2;
+    matchSetId ms;
 
-    std::string role;
+    vertexRole role = Role::none;
   };
 
   using vDesc = WG_t::vertex_descriptor;
@@ -62,53 +75,192 @@ namespace WG {
   using oeIter = WG_t::out_edge_iterator;
   using oeIterPair = std::pair<oeIter, oeIter>;
 
+  // index of an edge of the frozen graph.
+  using eIndex = std::size_t;
+  using oeRange = Csr<wgEdgeProps>::edgeRange;
+
+  /**
+   * side selectors: the grouping of a witness graph edge on the lhs (g1) or
+   * the rhs (g2). instantiated for both by the templates taking a Side.
+   */
+  struct Lhs {
+    static groupingId grouping(const wgEdgeProps &ep) { return ep.gp1; }
+  };
+
+  struct Rhs {
+    static groupingId grouping(const wgEdgeProps &ep) { return ep.gp2; }
+  };
+
+  /**
+   * closures under the empty moves of one side, i.e. the edges whose
+   * grouping on that side is empty, as the condensation of those edges. the
+   * closure of a vertex is the union of the components reachable from its
+   * own, see WG::getClosure.
+   */
+  struct Closures {
+    std::vector<std::size_t> component;
+
+    // members of component c, ascending: members[memberOffsets[c]] ..
+    // members[memberOffsets[c+1]-1]. the components c has empty edges to are
+    // succs[succOffsets[c]] .. succs[succOffsets[c+1]-1].
+    std::vector<std::size_t> memberOffsets;
+    std::vector<WG::vDesc> members;
+    std::vector<std::size_t> succOffsets;
+    std::vector<std::size_t> succs;
+
+    // components reached by the running WG::getClosure, all false otherwise.
+    std::vector<bool> visited;
+  };
+
+  /**
+   * out-edges bucketed by the grouping of one side. only the non-empty
+   * buckets are stored: groupings lists their groupings in ascending order,
+   * the edges of groupings[i] are edges[offsets[i]] .. edges[offsets[i+1]-1],
+   * in their old order. slot maps a grouping to its i.
+   *
+   * slot and count are width-sized, they are allocated once and only the
+   * entries of the non-empty buckets are reset, so bucketing costs the number
+   * of edges and not the width.
+   */
+  struct Buckets {
+    static const std::size_t npos = SIZE_MAX;
+
+    std::vector<groupingId> groupings;
+    std::vector<std::size_t> offsets;
+    std::vector<WG::eIndex> edges;
+
+    std::vector<std::size_t> slot;
+    std::vector<std::size_t> count;
+
+    bool empty(const groupingId &gp) const { return gp >= slot.size() || slot[gp] == npos; }
+  };
+
+  using bucketRange = Range<std::vector<WG::eIndex>::const_iterator>;
+
+  /**
+   * builds the witness graph of g1 and g2 one vertex at a time. the start
+   * vertex is added by the constructor, expand(v) adds the out-edges of v and
+   * the vertices they lead to. WG::create expands all vertices, a search that
+   * stops early only expands the ones it reaches.
+   */
+  class Builder {
+  public:
+    Builder(WG_t &wg, const DG_t &g1, const DG_t &g2, labelGroupingMap &lgm1,
+            labelGroupingMap &lgm2, const alignment &alm);
+
+    const WG_t &graph() const;
+    void expand(const WG::vDesc &v, std::vector<WG::vDesc> &found);
+
+  private:
+    WG::vDesc add(WG::Vertex &v);
+    WG::vDesc get(WG::Vertex &v, std::vector<WG::vDesc> &found);
+    void addEdge(const groupingId &gp1, const groupingId &gp2, const WG::vDesc &dst);
+
+    WG_t &wg;
+    const DG_t &g1;
+    const DG_t &g2;
+    labelGroupingMap &lgm1;
+    labelGroupingMap &lgm2;
+
+    std::vector<bool> expanded;
+
+    // out-edges of the vertex being expanded, keyed by groupings and target.
+    std::vector<std::pair<WG::vDesc, wgEdgeProps>> row;
+    HashIndex rowIndex;
+  };
+
+  /**
+   * the witness graph a DWG::Builder determinizes on one side, with the
+   * closure under the empty moves of that side. Frozen reads a finished graph
+   * and computes the condensation of its empty moves up front. OnDemand
+   * expands the vertices of a WG::Builder when they are first read, so a
+   * closure is a search that expands the vertices it passes.
+   *
+   * only --verdict of iso-decision and the iso-search adapter use OnDemand.
+   * the default iso-decision run writes the witness graph, so it builds the
+   * whole graph with WG::create and compares against it through Frozen. the
+   * DGs are always built in full.
+   */
+  template <typename Side>
+  class Frozen {
+  public:
+    explicit Frozen(const WG_t &wg);
+
+    const WG_t &graph() const;
+    void expand(const WG::vDesc &) {}
+    std::vector<WG::vDesc> closure(const std::vector<WG::vDesc> &vs);
+
+  private:
+    const WG_t &wg;
+    WG::Closures closures;
+  };
+
+  template <typename Side>
+  class OnDemand {
+  public:
+    explicit OnDemand(WG::Builder &b);
+
+    const WG_t &graph() const;
+    void expand(const WG::vDesc &v);
+    std::vector<WG::vDesc> closure(const std::vector<WG::vDesc> &vs);
+
+  private:
+    WG::Builder &b;
+
+    std::vector<WG::vDesc> found;
+    std::vector<bool> marked;
+  };
+
   WG_t create(const DG_t &g1, const DG_t &g2, labelGroupingMap &lgm1,
               labelGroupingMap &lgm2, const alignment &alm);
+  void freeze(WG_t &wg);
+  WG_t trim(const WG_t &wg);
+
+  template <typename Side>
+  WG::Closures getEmptyClosures(const WG_t &wg);
+  std::vector<WG::vDesc> getClosure(WG::Closures &cl, const std::vector<WG::vDesc> &vs);
 
-  WG::Vertex createVertex(const vName &v1, const vName &v2, const matchSet &ms);
+  WG::Vertex createVertex(const DG::vDesc &v1, const DG::vDesc &v2, const matchSetId &ms);
   WG::vDesc getVertex(const WG::Vertex &v, const WG_t &wg);
+  WG::vDesc findVertex(const WG::Vertex &v, const WG_t &wg);
   WG::vDesc addVertex(const WG::Vertex &v, WG_t &wg);
 
-  WG::eDesc addEdge(WG::vDesc &v1, const alignmentGrouping &gp1,
-                    const alignmentGrouping &gp2, WG::vDesc &v2, WG_t &wg);
+  WG::eDesc addEdge(WG::vDesc &v1, const groupingId &gp1,
+                    const groupingId &gp2, WG::vDesc &v2, WG_t &wg);
 
-  std::string getVertexName(const WG::Vertex &v);
+  std::string getVertexName(const WG_t &wg, const WG::vDesc &v, const DG_t &g1, const DG_t &g2);
+  std::string getVertexKey(const WG::Vertex &v);
+  std::size_t hashVertex(const WG::Vertex &v);
   WG::vDesc getStart(const WG_t &wg);
 
-  bool isFinalState(const WG::vDesc &wgv);
+  bool isFinalState(const WG_t &wg, const WG::vDesc &wgv);
+  void setFinalState(WG_t &wg, const WG::vDesc &wgv);
 
   bool hasVertex(const WG::Vertex &v, const WG_t &wg);
   bool vertexEqual(const WG::Vertex &v1, const WG::Vertex &v2);
 
-  bool hasEdgeLhs(const std::vector<WG::eDesc> &oes,const alignmentGrouping &gp, const WG_t &wg);
-  bool hasEdgeRhs(const std::vector<WG::eDesc> &oes, const alignmentGrouping &gp, const WG_t &wg);
-
-  bool hasEmptyTransitionLhs(const Range<WG::oeIter> &oes, const WG_t &wg);
-  bool hasEmptyTransitionRhs(const Range<WG::oeIter> &oes, const WG_t &wg);
-
-  bool hasEmptyTransitionLhs(const std::vector<WG::eDesc> &oes, const WG_t &wg);
-  bool hasEmptyTransitionRhs(const std::vector<WG::eDesc> &oes, const WG_t &wg);
-
-  std::vector<WG::eDesc> getEdgesWithLabelLhs(const std::vector<WG::eDesc> &oes, const alignmentGrouping &gp, const WG_t &wg);
-  std::vector<WG::eDesc> getEdgesWithLabelRhs(const std::vector<WG::eDesc> &oes, const alignmentGrouping &gp, const WG_t &wg);
+  WG::oeRange getOutEdges(const WG_t &wg, const WG::vDesc &v);
+  const wgEdgeProps &getEdge(const WG_t &wg, const WG::eIndex &e);
+  WG::vDesc getTarget(const WG_t &wg, const WG::eIndex &e);
 
+  template <typename Side>
+  void bucket(const std::vector<WG::eIndex> &oes, const std::size_t &width, const WG_t &wg, WG::Buckets &b);
+  WG::bucketRange getBucket(const WG::Buckets &b, const groupingId &gp);
 
-  std::vector<WG::vDesc> getDestinations(const std::vector<WG::eDesc> &es, const WG_t &wg);
+  std::vector<WG::vDesc> getDestinations(const WG::bucketRange &es, const WG_t &wg);
 
-  std::vector<WG::eDesc> getEmptyEdgesLhs(const Range<WG::oeIter> &oes, const WG_t &wg);
-  std::vector<WG::eDesc> getEmptyEdgesRhs(const Range<WG::oeIter> &oes, const WG_t &wg);
 
 
 
 
-  void print(const WG_t &wg);
-  void write(const WG_t &wg, std::ostream& target);
-  void writeOutEdges(const WG_t &wg, const WG::vDesc &v, std::ostream& target);
-  void writeOutEdge(const WG_t &wg, const WG::eDesc &e, std::ostream& target);
+  void print(const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt);
+  void write(const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt, std::ostream& target);
+  void writeOutEdges(const WG_t &wg, const WG::vDesc &v, const DG_t &g1, const DG_t &g2, const groupingTable &gt, std::ostream& target);
+  void writeOutEdge(const WG_t &wg, const WG::eIndex &e, const DG_t &g1, const DG_t &g2, const groupingTable &gt, std::ostream& target);
 
   void printDebug(const WG_t &wg);
   void printOutEdgesDebug(const WG_t &wg, const WG::vDesc &v);
-  void printOutEdgeDebug(const WG_t &wg, const WG::eDesc &e);
+  void printOutEdgeDebug(const WG_t &wg, const WG::eIndex &e);
 }
 
 #endif // __WITNESSUTILS_HPP__
@@ -31,8 +31,8 @@ alignmentGroup Alm::getGroup(json::array_t a)
 {
   alignmentGroup g;
 
-  for (const label &l : a)
-    g.push_back(l);
+  for (const std::string &l : a)
+    Alm::addLabel(g, Lbl::intern(l));
 
   return g;
 }
@@ -76,16 +76,59 @@ almMap Alm::AlmMap(const alignment &alm)
   return m;
 }
 
-bool Alm::hasLabel(const alignmentGroup &g, const label &l)
+alignmentIndex Alm::buildIndex(const alignment &alm)
+{
+  alignmentIndex idx;
+
+  for (std::size_t i = 0; i < alm.size(); ++i) {
+    for (label l : alm[i].first) {
+      if (l >= idx.lhs.size())
+        idx.lhs.resize(l + 1);
+
+      idx.lhs[l].set(i);
+    }
+
+    for (label l : alm[i].second) {
+      if (l >= idx.rhs.size())
+        idx.rhs.resize(l + 1);
+
+      idx.rhs[l].set(i);
+    }
+  }
+
+  return idx;
+}
+
+namespace {
+  const Bitset noPairs;
+}
+
+/**
+ * indices of the pairs with l in their left group, empty if there are none.
+ */
+const Bitset &Alm::pairsWithLhs(const alignmentIndex &idx, const label &l)
 {
-  alignmentGroup::const_iterator it;
+  return (l < idx.lhs.size()) ? idx.lhs[l] : noPairs;
+}
 
-  it = std::find(g.begin(), g.end(), l);
+/**
+ * indices of the pairs with l in their right group, empty if there are none.
+ */
+const Bitset &Alm::pairsWithRhs(const alignmentIndex &idx, const label &l)
+{
+  return (l < idx.rhs.size()) ? idx.rhs[l] : noPairs;
+}
 
-  if (it == g.end())
-    return false;
+void Alm::addLabel(alignmentGroup &g, const label &l)
+{
+  g.set(l);
 
-  return true;
+  return;
+}
+
+bool Alm::hasLabel(const alignmentGroup &g, const label &l)
+{
+  return g.test(l);
 }
 
 bool Alm::hasPair(const alignment &alm, const alignmentPair &p)
@@ -100,7 +143,7 @@ bool Alm::hasPair(const alignment &alm, const alignmentPair &p)
 
 bool Alm::groupEqual(const alignmentGroup &g1, const alignmentGroup &g2)
 {
-  return std::equal(g1.begin(), g1.end(), g2.begin(), g2.end());
+  return g1 == g2;
 }
 
 bool Alm::groupingEqual(const alignmentGrouping &gp1, const alignmentGrouping &gp2)
@@ -120,14 +163,50 @@ alignmentGrouping Alm::getGrouping(const label &l, const alignmentHalf &alh)
   return res;
 }
 
+groupingId Alm::internGrouping(groupingTable &gt, const alignmentGrouping &gp)
+{
+  std::unordered_map<alignmentGrouping, groupingId, groupingHash>::const_iterator it = gt.ids.find(gp);
+
+  if (it != gt.ids.end())
+    return it->second;
+
+  groupingId id = gt.groupings.size();
+
+  gt.groupings.push_back(gp);
+  gt.ids[gp] = id;
+
+  return id;
+}
+
+const alignmentGrouping &Alm::lookupGrouping(const groupingTable &gt, const groupingId &id)
+{
+  return gt.groupings[id];
+}
+
 label Alm::getLabelFromGrouping(const alignmentGrouping &gp)
 {
-  return gp[0][0];
+  return gp[0].first();
+}
+
+/**
+ * names of the labels in group g. groups are label sets, so the names are
+ * sorted to get a stable output independent of the label ids.
+ */
+std::vector<std::string> Alm::groupToNames(const alignmentGroup &g)
+{
+  std::vector<std::string> names;
+
+  for (label l : g)
+    names.push_back(Lbl::name(l));
+
+  std::sort(names.begin(), names.end());
+
+  return names;
 }
 
 std::string Alm::groupToStr(const alignmentGroup &g)
 {
-  std::string res = boost::algorithm::join(g, ",");
+  std::string res = boost::algorithm::join(Alm::groupToNames(g), ",");
 
   return res;
 }
@@ -147,6 +226,11 @@ std::string Alm::groupingToStr(const alignmentGrouping &gp)
   return res;
 }
 
+std::string Alm::groupingToStr(const groupingTable &gt, const groupingId &id)
+{
+  return Alm::groupingToStr(Alm::lookupGrouping(gt, id));
+}
+
 
 
 
@@ -202,13 +286,7 @@ void Alm::printGrouping(const alignmentGrouping &gp)
 
 void Alm::printGroup(const alignmentGroup &g)
 {
-  alignmentGroup::const_iterator it;
-
-  for (it = g.begin(); it != (g.end() - 1); ++it)
-    std::cout << *it << ", ";
-
-  std::cout << *it;
-
+  std::cout << boost::algorithm::join(Alm::groupToNames(g), ", ");
 
   return;
 }
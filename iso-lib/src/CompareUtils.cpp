@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <string>
 #include <boost/algorithm/string/join.hpp>
 
 #include "CompareUtils.hpp"
+#include "SubsetConstruction.hpp"
 
 #include "Logging.hpp"
 
@@ -10,133 +12,357 @@ bool Cmp::isExitCondition(const Cmp::VertexPair &v, const DG_t &g, const DWG_t &
   DG::vDesc gv = v.gv;
   DWG::vDesc dwgv = v.dwgv;
 
-  if ((g[gv].role == "end") && (dwg[dwgv].role != "end"))
+  if (DG::isFinalState(g, gv) && !DWG::isFinalState(dwg, dwgv))
     return true;
 
   return false;
 }
 
-bool Cmp::alreadyVisited(const Cmp::Vertex &v, std::vector<Cmp::Vertex> visited)
+std::size_t Cmp::hashPair(const Cmp::VertexPair &vp)
 {
+  return HashIndex::combine(HashIndex::combine(0, vp.gv), vp.dwgv);
+}
 
-  for (const Cmp::Vertex &vv : visited) {
-    if (v.pair == vv.pair)
-      return true;
-  }
-
-  return false;
+/**
+ * index of vp in visited, or HashIndex::npos if it has not been reached yet.
+ */
+std::size_t Cmp::findVisited(const Cmp::VertexPair &vp, const std::vector<Cmp::Vertex> &visited, const HashIndex &index)
+{
+  return index.find(Cmp::hashPair(vp), [&](const std::size_t &i) {
+    return visited[i].pair == vp;
+  });
 }
 
-bool Cmp::isEqual(const DG_t &g, const DWG_t &dwg, const labelGroupingMap &lgm) {
+namespace {
+  /**
+   * breadth-first search over the product of g and dwg for a pair that is an
+   * exit condition. move(v, gp) gives the destination of dwg from v for
+   * grouping gp, dwg may still be built while the search runs.
+   */
+  template <typename F>
+  bool search(const DG_t &g, const DWG_t &dwg, const DWG::vDesc &dwgStart, const F &move)
+  {
+    DG::vDesc gStart = DG::getStart(g);
 
-  DG::vDesc gStart = DG::getStart(g);
-  DWG::vDesc dwgStart = DWG::getStart(dwg);
+    Cmp::Vertex start(gStart, dwgStart);
 
-  Cmp::Vertex start(gStart, dwgStart);
+    if (Cmp::isExitCondition(start.pair, g, dwg))
+      return false;
 
-  if (isExitCondition(start.pair, g, dwg))
-    return false;
+    // every pair that was reached, in the order it was reached. pairs are marked
+    // when they are queued, so each one is expanded once. the todo queue holds
+    // indices into visited.
+    std::vector<Cmp::Vertex> visited;
+    HashIndex index;
+
+    visited.push_back(start);
+    index.insert(Cmp::hashPair(start.pair), 0);
+
+    std::deque<std::size_t> cmpTodo;
+    cmpTodo.push_back(0);
+
+    const Csr<dgEdgeProps> &csr = g[boost::graph_bundle].csr;
+
+
+    while (!cmpTodo.empty()) {
 
-  std::deque<Cmp::Vertex> cmpTodo;
-  cmpTodo.push_back(start);
+      std::size_t curr = cmpTodo.front();
+      cmpTodo.pop_front();
 
-  std::vector<Cmp::Vertex> visited;
+      DG::vDesc gv = visited[curr].pair.gv;
+      DWG::vDesc dwgv = visited[curr].pair.dwgv;
 
+      DEBUG << "working on: " << Cmp::vpToString(visited[curr].pair, g) << std::endl;
 
-  //for (int i = 0; i < 5; i++) {
-  while (!cmpTodo.empty()) {
+      for (const std::size_t &e : csr.outEdges(gv)) {
 
-    Cmp::Vertex curr = cmpTodo.front();
-    cmpTodo.pop_front();
+        const dgEdgeProps &ep = csr.data(e);
 
-    visited.push_back(curr);
+        DEBUG << "  checking label " << Lbl::name(ep.label) << std::endl;
 
-    DG::vDesc gv = curr.pair.gv;
-    DWG::vDesc dwgv = curr.pair.dwgv;
+        // g is deterministic, so the destination in g is the target of the edge.
+        // the edge also carries its grouping, which selects the move in dwg. a
+        // missing move in dwg goes to DWG::dead, which stays there.
+        DG::vDesc gDst = csr.target(e);
+        DWG::vDesc dwgDst = move(dwgv, ep.gp);
 
-    DEBUG << "working on: " << Cmp::vpToString(curr.pair, g, dwg) << std::endl;
+        Cmp::Vertex dst(gDst, dwgDst, curr);
 
-    Range<DG::oeIter> oes = DG::getOutEdges(g, gv);
+        DEBUG << "  destination: " << Cmp::vpToString(dst.pair, g) << std::endl;
 
-    for (const DG::eDesc &e : oes) {
+        if (Cmp::isExitCondition(dst.pair, g, dwg)) {
+          IF_DEBUG(
+            std::vector<Cmp::VertexPair> path = Cmp::getPath(visited, curr);
+            path.push_back(dst.pair);
 
-      label l = g[e].label;
+            DEBUG << "\nexit condition at: " << Cmp::pathToString(path, g) << std::endl;
+          )
 
-      DEBUG << "  checking label " << l << std::endl;
+          return false;
+        }
 
-      DG::vDesc gDst = DG::getDst(gv, l, g);
-      DWG::vDesc dwgDst = DWG::getDst(dwgv, lgm.find(l)->second, dwg);
+        if (Cmp::findVisited(dst.pair, visited, index) != HashIndex::npos) {
+          DEBUG << "  destination already visited. continue.\n\n";
 
-      Cmp::Vertex dst(gDst, dwgDst);
-      Cmp::inheritPath(dst, curr);
+          continue;
+        }
 
-      DEBUG << "  destination: " << Cmp::vpToString(dst.pair, g, dwg) << std::endl;
+        DEBUG << "  adding new destination\n\n";
 
-      if (isExitCondition(dst.pair, g, dwg)) {
-        // std::cout << "\nexit condition at: " << vertexToString(dst, g, dwg) << std::endl;
-        return false;
+        index.insert(Cmp::hashPair(dst.pair), visited.size());
+        cmpTodo.push_back(visited.size());
+        visited.push_back(dst);
       }
 
-      if (alreadyVisited(dst, visited)) {
-        DEBUG << "  destination already visited. continue.\n\n";
+      IF_DEBUG(
+        DEBUG << "ToDo:\n";
+
+        for (const std::size_t &v : cmpTodo)
+          DEBUG << Cmp::vpToString(visited[v].pair, g) << std::endl;
+
+        DEBUG << "\n\n\n\n\n";
+      )
+    }
+
+    return true;
+  }
+
+  /**
+   * Cmp::isEqual on a dwg of the given side that is only built as far as the
+   * search reaches, see Subset::Lazy. source is a WG::Frozen or WG::OnDemand.
+   */
+  template <typename Side, typename Source>
+  bool isEqualOnTheFly(const DG_t &g, Source &source, const edgeLabelSet &els)
+  {
+    DWG_t dwg;
+
+    DWG::Builder<Side, Source> b(dwg, source, els);
+    Subset::Lazy<DWG::Builder<Side, Source>> lazy(b);
+
+    return search(g, dwg, lazy.start(), [&](const DWG::vDesc &v, const groupingId &gp) {
+      if (v == DWG::dead)
+        return DWG::dead;
+
+      lazy.expand(v, [](const std::size_t &) {});
 
+      return DWG::getDst(v, gp, dwg);
+    });
+  }
+
+  /**
+   * node of the antichain search: a state of g and the closed set of witness
+   * graph vertices the dwg would be in. the empty set stands for DWG::dead.
+   */
+  struct AntichainNode {
+    DG::vDesc gv;
+    std::vector<WG::vDesc> vs;
+    bool removed;
+  };
+
+  bool isFinalSet(const WG_t &wg, const std::vector<WG::vDesc> &vs)
+  {
+    for (const WG::vDesc &v : vs) {
+      if (WG::isFinalState(wg, v))
+        return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * same question as isEqualOnTheFly, but no dwg is built. the search runs over
+   * pairs (state of g, vertex set) and keeps only the subset-minimal sets per
+   * state of g: a pair whose set includes that of another pair for the same
+   * state cannot fail unless the smaller one does, so it is dropped, and it
+   * replaces pairs with larger sets.
+   *
+   * the successor of a set is the closure of its destinations, as in the dwg.
+   * the start set is not closed and never final, same as in the dwg, and is
+   * not compared with other sets.
+   */
+  template <typename Side>
+  bool isIncluded(const DG_t &g, const WG_t &wg, const edgeLabelSet &els)
+  {
+    WG::Closures closures = WG::getEmptyClosures<Side>(wg);
+    const std::size_t width = els.empty() ? 0 : *els.rbegin() + 1;
+
+    std::vector<bool> inEls(width, false);
+
+    for (const groupingId &gp : els)
+      inEls[gp] = true;
+
+    const Csr<dgEdgeProps> &csr = g[boost::graph_bundle].csr;
+
+    if (DG::isFinalState(g, DG::getStart(g)))
+      return false;
+
+    std::vector<AntichainNode> nodes;
+    nodes.push_back(AntichainNode{DG::getStart(g), std::vector<WG::vDesc>(1, WG::getStart(wg)), false});
+
+    // per state of g, the nodes whose sets are minimal so far.
+    std::vector<std::vector<std::size_t>> antichains(csr.numVertices());
+
+    std::deque<std::size_t> todo;
+    todo.push_back(0);
+
+    std::vector<WG::eIndex> oedges;
+    WG::Buckets buckets;
+
+    while (!todo.empty()) {
+      const std::size_t curr = todo.front();
+      todo.pop_front();
+
+      if (nodes[curr].removed)
         continue;
+
+      const DG::vDesc gv = nodes[curr].gv;
+
+      oedges.clear();
+
+      for (const WG::vDesc &wgv : nodes[curr].vs) {
+        for (const WG::eIndex &e : WG::getOutEdges(wg, wgv))
+          oedges.push_back(e);
       }
 
-      DEBUG << "  adding new destination\n\n";
+      WG::bucket<Side>(oedges, width, wg, buckets);
 
-      cmpTodo.push_back(dst);
-    }
+      for (const std::size_t &e : csr.outEdges(gv)) {
+        const groupingId gp = csr.data(e).gp;
+        const DG::vDesc gDst = csr.target(e);
 
-    IF_DEBUG(
-      DEBUG << "ToDo:\n";
+        std::vector<WG::vDesc> vs;
 
-      for (const Cmp::Vertex &v : cmpTodo)
-        DEBUG << Cmp::vpToString(v.pair, g, dwg) << std::endl;
+        if (gp < width && inEls[gp] && !buckets.empty(gp))
+          vs = WG::getClosure(closures, WG::getDestinations(WG::getBucket(buckets, gp), wg));
 
-      DEBUG << "\nVisited:\n";
-      for (const Cmp::Vertex &v : visited)
-        DEBUG << Cmp::vpToString(v.pair, g, dwg) << std::endl;
+        if (DG::isFinalState(g, gDst) && !isFinalSet(wg, vs)) {
+          DEBUG << "exit condition at: " << DG::getVertexName(g, gDst) << std::endl;
 
-      DEBUG << "\n\n\n\n\n";
-    )
+          return false;
+        }
+
+        std::vector<std::size_t> &ac = antichains[gDst];
+
+        const bool subsumed = std::any_of(ac.begin(), ac.end(), [&](const std::size_t &i) {
+          return std::includes(vs.begin(), vs.end(), nodes[i].vs.begin(), nodes[i].vs.end());
+        });
+
+        if (subsumed)
+          continue;
+
+        ac.erase(std::remove_if(ac.begin(), ac.end(), [&](const std::size_t &i) {
+          if (!std::includes(nodes[i].vs.begin(), nodes[i].vs.end(), vs.begin(), vs.end()))
+            return false;
+
+          nodes[i].removed = true;
+          std::vector<WG::vDesc>().swap(nodes[i].vs);
+
+          return true;
+        }), ac.end());
+
+        ac.push_back(nodes.size());
+        todo.push_back(nodes.size());
+        nodes.push_back(AntichainNode{gDst, std::move(vs), false});
+      }
+    }
+
+    return true;
   }
+}
+
+bool Cmp::isEqual(const DG_t &g, const DWG_t &dwg)
+{
+  return search(g, dwg, DWG::getStart(dwg), [&](const DWG::vDesc &v, const groupingId &gp) {
+    return DWG::getDst(v, gp, dwg);
+  });
+}
+
+/**
+ * Cmp::isEqual(g, DWG::createLhs(wg, els)), but the states of the dwg are
+ * only created when the search reaches them, and it stops at the first
+ * counterexample.
+ */
+bool Cmp::isEqualLhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els)
+{
+  WG::Frozen<WG::Lhs> source(wg);
+
+  return isEqualOnTheFly<WG::Lhs>(g, source, els);
+}
+
+bool Cmp::isEqualRhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els)
+{
+  WG::Frozen<WG::Rhs> source(wg);
 
-  return true;
+  return isEqualOnTheFly<WG::Rhs>(g, source, els);
 }
 
-void Cmp::inheritPath(Cmp::Vertex &v, const Cmp::Vertex &vpath)
+/**
+ * same as above, but the witness graph is built by wgb while the search runs,
+ * only the vertices the dwg states reach are expanded. wgb can be used for
+ * both sides, the vertices expanded for one are not expanded again.
+ */
+bool Cmp::isEqualLhs(const DG_t &g, WG::Builder &wgb, const edgeLabelSet &els)
 {
-  for (const VertexPair &vp : vpath.path)
-    v.path.push_back(vp);
+  WG::OnDemand<WG::Lhs> source(wgb);
 
-  v.path.push_back(vpath.pair);
+  return isEqualOnTheFly<WG::Lhs>(g, source, els);
 }
 
-std::string Cmp::vpToString(const Cmp::VertexPair &vp, const DG_t &g, const DWG_t &dwg)
+bool Cmp::isEqualRhs(const DG_t &g, WG::Builder &wgb, const edgeLabelSet &els)
+{
+  WG::OnDemand<WG::Rhs> source(wgb);
+
+  return isEqualOnTheFly<WG::Rhs>(g, source, els);
+}
+
+/**
+ * Cmp::isEqualLhs/Rhs by an antichain search, which keeps only the
+ * subset-minimal vertex sets per state of g instead of all dwg states.
+ */
+bool Cmp::isIncludedLhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els)
+{
+  return isIncluded<WG::Lhs>(g, wg, els);
+}
+
+bool Cmp::isIncludedRhs(const DG_t &g, const WG_t &wg, const edgeLabelSet &els)
+{
+  return isIncluded<WG::Rhs>(g, wg, els);
+}
+
+/**
+ * the pairs on the search path from the start to visited[i], both included.
+ */
+std::vector<Cmp::VertexPair> Cmp::getPath(const std::vector<Cmp::Vertex> &visited, std::size_t i)
+{
+  std::vector<Cmp::VertexPair> path;
+
+  for (; i != Cmp::Vertex::npos; i = visited[i].parent)
+    path.push_back(visited[i].pair);
+
+  std::reverse(path.begin(), path.end());
+
+  return path;
+}
+
+std::string Cmp::vpToString(const Cmp::VertexPair &vp, const DG_t &g)
 {
   DG::vDesc gv = vp.gv;
   DWG::vDesc dwgv = vp.dwgv;
 
   std::string res = "";
-  res +=  g[gv].name;
+  res += DG::getVertexName(g, gv);
   res += ", ";
-  res += dwg[dwgv].name;
+  res += (dwgv == DWG::dead) ? "{}" : "#" + std::to_string(dwgv);
 
   return res;
 }
 
-std::string Cmp::vertexToString(const Cmp::Vertex &v, const DG_t &g, const DWG_t &dwg)
+std::string Cmp::pathToString(const std::vector<Cmp::VertexPair> &path, const DG_t &g)
 {
-  std::string res = Cmp::vpToString(v.pair, g, dwg);
-
-
   std::vector<std::string> tmp;
 
-  for (const Cmp::VertexPair &p : v.path)
-    tmp.push_back(Cmp::vpToString(p, g, dwg));
+  for (const Cmp::VertexPair &p : path)
+    tmp.push_back(Cmp::vpToString(p, g));
 
-  res += "  [" + boost::algorithm::join(tmp, " -> ") + "]";
-
-  return res;
+  return "[" + boost::algorithm::join(tmp, " -> ") + "]";
 }
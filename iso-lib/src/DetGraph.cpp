@@ -1,316 +1,470 @@
 #include <algorithm>
+#include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "DetGraph.hpp"
+#include "HashIndex.hpp"
 #include "HelperMaps.hpp"
+#include "Partition.hpp"
+#include "SubsetConstruction.hpp"
 
 
 
-DG_t DG::determinize(const Graph_t &g, const edgeLabelSet &els)
-{
-  DG_t dg;
+namespace {
+  /**
+   * builder for Subset::construct. states are bitsets over the states of g,
+   * the successors of a state for a grouping are the union of the
+   * precomputed, epsilon-closed successors of its members.
+   */
+  class DetBuilder {
+  public:
+    using set_t  = Bitset;
+    using edge_t = dgEdgeProps;
 
-  Graph::vDesc gStart = Graph::getStart(g);
-  DG::Vertex dgStart = DG::createStart();
+    DetBuilder(DG_t &dg, const Graph_t &g, const edgeLabelSet &els)
+      : dg(dg), g(g), succs(DG::getSuccessors(g, els))
+    {
+      const std::size_t width = els.empty() ? 0 : *els.rbegin() + 1;
 
-  DG::addVertexToSet(gStart, dgStart);
-  DG::updateVertexName(dgStart, g);
+      dsts.resize(width);
+      labels.resize(width);
+    }
 
-  DG::vDesc dgStartvd = DG::addVertex(dg, dgStart);
+    Bitset start() const
+    {
+      Bitset s;
+      s.set(Graph::getStart(g));
 
-  std::deque<DG::vDesc> dgTodo;
-  dgTodo.push_back(dgStartvd);
+      return s;
+    }
 
-  while (!dgTodo.empty()) {
+    // the start state is not epsilon-closed and never final.
+    std::size_t add(const Bitset &s, const bool &isStart)
+    {
+      DG::Vertex nv = isStart ? DG::createStart() : DG::createVertex(s, g);
 
-    DG::vDesc curr = dgTodo.front();
-    dgTodo.pop_front();
+      if (isStart)
+        nv.vs.assign(s.begin(), s.end());
 
-    std::vector<Graph::eDesc> outEdges = DG::getOutEdges(dg, curr, g);
+      sets.push_back(s);
 
-    for (const alignmentGrouping &gp : els) {
-      // skip empty groupings as they will be processed via epsilon closure
-      if (gp.empty())
-          continue;
-          
-      // we get this label from DG::hasEdgeForGrouping(_, _, _, l)
-      label l /*= Alm::getLabelFromGrouping(gp)*/;
+      return DG::addVertex(dg, nv);
+    }
 
-      if (!DG::hasEdgeForGrouping(g, outEdges, gp, l))
-        continue;
+    const Bitset &get(const std::size_t &v) const
+    {
+      return sets[v];
+    }
 
-      std::vector<Graph::eDesc> edges = DG::getEdgesForGrouping(g, outEdges, gp);
-      
-      // DONE: could use unique set instead of vector to prevent nodes like "{4,4}" and
-      //       possibly prevent errors if there is another node "{4}".
-      //       Since DG::hasVertex tests for name "{4,4}" != "{4}" has potential for errors. 
-      std::set<Graph::vDesc> dsts = Graph::getDestinationsWithEpsilonClosure(g, edges);
+    std::size_t hash(const Bitset &s) const
+    {
+      return s.hash();
+    }
 
-      DG::Vertex nv = DG::createVertex(dsts, g);
-      DG::updateVertexName(nv, g);
+    HashIndex &index()
+    {
+      return idx;
+    }
 
-      if (DG::hasVertex(dg, nv))
-      {
-        // vertex already exists. only add a new edge with the current label l.
-        
-        DG::vDesc existingDst = DG::getVertexByName(dg, nv.name);
-        DG::addEdge(dg, curr, l, existingDst);
-        
-        // no need to process this node again so do not put it in our todo queue.
+    void expand(const std::size_t &v, std::vector<std::pair<dgEdgeProps, Bitset>> &out)
+    {
+      Bitset found;
+
+      // members are visited in ascending order, so the first edge of the
+      // smallest member with a grouping gives the label of the dg edge.
+      for (const std::size_t &gv : sets[v]) {
+        for (const DG::Successor &sc : succs[gv]) {
+          if (!found.test(sc.gp)) {
+            found.set(sc.gp);
+            labels[sc.gp] = sc.l;
+          }
+
+          dsts[sc.gp] |= sc.dsts;
+        }
       }
-      else
-      {
-        // vertex didn't exist. insert it into the deterministic graph and add the edge.
-        
-        DG::vDesc nvd = DG::addVertex(dg, nv);
-        DG::addEdge(dg, curr, l, nvd);
-
-        // also put it in our todo queue.
-        dgTodo.push_back(nvd);
+
+      // ascending grouping ids, the order of els.
+      for (const std::size_t &gp : found) {
+        dgEdgeProps e;
+        e.label = labels[gp];
+        e.gp    = gp;
+
+        out.push_back(std::make_pair(e, std::move(dsts[gp])));
+        dsts[gp].clear();
       }
     }
-  }
 
-  return dg;
-}
+    void addEdge(const std::size_t &v, const dgEdgeProps &e, const std::size_t &dst)
+    {
+      DG::addEdge(dg, v, e.label, e.gp, dst);
+    }
 
-DG::Vertex DG::createVertex()
-{
-  DG::Vertex nv;
+  private:
+    DG_t &dg;
+    const Graph_t &g;
 
-  return nv;
+    const std::vector<std::vector<DG::Successor>> succs;
+
+    // states of dg as bitsets, indexed by descriptor.
+    std::vector<Bitset> sets;
+    HashIndex idx;
+
+    // successors of the current state per grouping, and the label of the
+    // first edge with that grouping. reused for every state.
+    std::vector<Bitset> dsts;
+    std::vector<label> labels;
+  };
 }
 
-DG::Vertex DG::createVertex(const std::vector<Graph::vDesc> &vertices, const Graph_t &g)
+DG_t DG::determinize(const Graph_t &g, const edgeLabelSet &els)
 {
-  DG::Vertex nv;
-  
-  for (const Graph::vDesc &v : vertices) {
-    DG::addVertexToSet(v, nv);
-    
-    if (Graph::isFinalState(g, v))
-      nv.role = "end";
-  }
-  
-  return nv;
+  DG_t dg;
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g)))
+    dg[boost::graph_bundle].srcNames.push_back(g[v].name);
+
+  DetBuilder b(dg, g, els);
+  Subset::construct(b);
+
+  DG::freeze(dg);
+
+  return dg;
 }
-DG::Vertex DG::createVertex(const std::set<Graph::vDesc> &vertices, const Graph_t &g)
+
+/**
+ * the minimal dg with the same behavior, by Hopcroft's partition refinement
+ * over the groupings. states are equivalent if they have the same role, the
+ * same (grouping, label) out-edges and equivalent successors, so the witness
+ * graph sees the same labels. the start state only shares a block with other
+ * start states, the witness graph and the dwg treat it specially.
+ *
+ * a merged state gets the union of the state sets of its members. if nothing
+ * can be merged, dg is returned as it is.
+ */
+DG_t DG::minimize(const DG_t &dg)
 {
-  DG::Vertex nv;
-  
-  for (const Graph::vDesc &v : vertices) {
-    DG::addVertexToSet(v, nv);
-    
-    if (Graph::isFinalState(g, v))
-      nv.role = "end";
+  const Csr<dgEdgeProps> &csr = dg[boost::graph_bundle].csr;
+  const std::size_t n = csr.numVertices();
+
+  // initial blocks by role and out-edge signature.
+  std::map<std::vector<std::size_t>, std::size_t> keys;
+  std::vector<std::size_t> initial(n);
+
+  for (std::size_t v = 0; v < n; ++v) {
+    std::vector<std::size_t> key(1, dg[v].role);
+
+    for (const std::size_t &e : csr.outEdges(v)) {
+      key.push_back(csr.data(e).gp);
+      key.push_back(csr.data(e).label);
+    }
+
+    initial[v] = keys.insert(std::make_pair(key, keys.size())).first->second;
   }
-  
-  return nv;
-}
 
-DG::Vertex DG::createStart()
-{
-  DG::Vertex nv;
-  nv.role = "start";
+  Partition p(initial, keys.size());
 
-  return nv;
-}
+  // in-edges (grouping, source) of every state.
+  std::vector<std::size_t> inOffsets(n + 1, 0);
+  std::vector<std::pair<groupingId, std::size_t>> in(csr.numEdges());
 
-DG::vDesc DG::getStart(const DG_t &dg)
-{
-  DG::vDesc res;
+  for (std::size_t v = 0; v < n; ++v) {
+    for (const std::size_t &e : csr.outEdges(v))
+      ++inOffsets[csr.target(e) + 1];
+  }
 
-  const Range<DG::vIter> vertices = Util::makeRange(boost::vertices(dg));
+  for (std::size_t v = 0; v < n; ++v)
+    inOffsets[v + 1] += inOffsets[v];
 
-  for (const DG::vDesc &vd : vertices) {
-    if (dg[vd].role == "start")
-      res =  vd;
+  std::vector<std::size_t> pos(inOffsets.begin(), inOffsets.end() - 1);
+
+  for (std::size_t v = 0; v < n; ++v) {
+    for (const std::size_t &e : csr.outEdges(v))
+      in[pos[csr.target(e)]++] = std::make_pair(csr.data(e).gp, v);
   }
 
-  return res;
-}
+  // blocks that still have to be used as splitters.
+  std::vector<std::size_t> waiting;
+  std::vector<bool> isWaiting(p.count(), true);
 
-bool DG::hasVertex(const DG_t &dg, const DG::Vertex &v)
-{
-  const Range<DG::vIter> vertices = Util::makeRange(boost::vertices(dg));
+  for (std::size_t b = 0; b < p.count(); ++b)
+    waiting.push_back(b);
 
-  for (const DG::vDesc &vd : vertices) {
-    if (dg[vd].name == v.name)
-      return true;
+  std::vector<std::pair<groupingId, std::size_t>> preds;
+
+  while (!waiting.empty()) {
+    const std::size_t splitter = waiting.back();
+    waiting.pop_back();
+    isWaiting[splitter] = false;
+
+    preds.clear();
+
+    for (std::vector<std::size_t>::const_iterator it = p.begin(splitter); it != p.end(splitter); ++it)
+      preds.insert(preds.end(), in.begin() + inOffsets[*it], in.begin() + inOffsets[*it + 1]);
+
+    std::sort(preds.begin(), preds.end());
+
+    // split by the predecessors for one grouping at a time.
+    for (std::size_t i = 0; i < preds.size();) {
+      std::size_t j = i;
+
+      for (; j < preds.size() && preds[j].first == preds[i].first; ++j)
+        p.mark(preds[j].second);
+
+      p.split([&](const std::size_t &b, const std::size_t &nb) {
+        isWaiting.push_back(false);
+
+        // if b is still waiting, both halves are. otherwise the smaller half
+        // is enough.
+        const std::size_t next = (isWaiting[b] || p.size(nb) <= p.size(b)) ? nb : b;
+
+        if (!isWaiting[next]) {
+          waiting.push_back(next);
+          isWaiting[next] = true;
+        }
+      });
+
+      i = j;
+    }
   }
 
-  return false;
-}
+  if (p.count() == n)
+    return dg;
 
-DG::vDesc DG::getVertexByName(const DG_t &dg, const std::string &name)
-{
-  DG::vDesc res;
+  // number the blocks breadth-first from the start, like the builders do.
+  const std::size_t none = SIZE_MAX;
+  std::vector<std::size_t> ids(p.count(), none);
+  std::vector<std::size_t> order;
 
-  const Range<DG::vIter> vertices = Util::makeRange(boost::vertices(dg));
+  ids[p.blockOf(DG::getStart(dg))] = 0;
+  order.push_back(p.blockOf(DG::getStart(dg)));
 
-  for (const DG::vDesc &vd : vertices) {
-    if (dg[vd].name == name)
-      res =  vd;
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    const std::size_t rep = *p.begin(order[i]);
+
+    for (const std::size_t &e : csr.outEdges(rep)) {
+      const std::size_t b = p.blockOf(csr.target(e));
+
+      if (ids[b] == none) {
+        ids[b] = order.size();
+        order.push_back(b);
+      }
+    }
   }
 
-  return res;
-}
+  DG_t min;
+  min[boost::graph_bundle].srcNames = dg[boost::graph_bundle].srcNames;
 
-void DG::addVertexToSet(const Graph::vDesc &gv, DG::Vertex &dgv)
-{
-  (dgv.vs).push_back(gv);
-  std::sort((dgv.vs).begin(), (dgv.vs).end());
+  for (const std::size_t &b : order) {
+    DG::Vertex nv;
+    nv.role = dg[*p.begin(b)].role;
 
-  return;
-}
+    for (std::vector<std::size_t>::const_iterator it = p.begin(b); it != p.end(b); ++it)
+      nv.vs.insert(nv.vs.end(), dg[*it].vs.begin(), dg[*it].vs.end());
 
-void DG::updateVertexName(DG::Vertex &dgv, const Graph_t &g)
-{
-  std::stringstream name;
-  name << "{";
+    std::sort(nv.vs.begin(), nv.vs.end());
+    nv.vs.erase(std::unique(nv.vs.begin(), nv.vs.end()), nv.vs.end());
 
-  std::vector<Graph::vDesc>::iterator it;
+    DG::addVertex(min, nv);
+  }
 
-  for (it = (dgv.vs).begin(); it != ((dgv.vs).end() - 1); ++it)
-    name << g[*it].name << ", ";
+  for (const std::size_t &b : order) {
+    const std::size_t rep = *p.begin(b);
 
-  name << g[*it].name << "}";
+    for (const std::size_t &e : csr.outEdges(rep))
+      DG::addEdge(min, ids[b], csr.data(e).label, csr.data(e).gp, ids[p.blockOf(csr.target(e))]);
+  }
 
-  dgv.name = name.str();
+  DG::freeze(min);
 
-  return;
+  return min;
 }
 
-void DG::updateVertexName(DG_t &dg, const DG::vDesc &v, const Graph_t &g)
+/**
+ * for every state of g, the epsilon-closed successors for each grouping of
+ * els it has an edge for, in ascending grouping order.
+ *
+ * an edge of the dg stands for all edges of its grouping, but only has one
+ * label: the label of the first such edge. for example, consider from the
+ * paper example state II and edge x. this edge will have the alignment
+ * grouping {{s,w,x}}. in the determinized graph this edge will then also get
+ * label x.
+ */
+std::vector<std::vector<DG::Successor>> DG::getSuccessors(const Graph_t &g, const edgeLabelSet &els)
 {
-  std::stringstream name;
-  name << "{";
+  std::vector<std::vector<DG::Successor>> succs(boost::num_vertices(g));
+  const std::vector<Bitset> closures = Graph::getEpsilonClosures(g);
 
-  std::vector<Graph::vDesc>::iterator it;
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    std::map<groupingId, std::vector<Graph::eDesc>> buckets;
 
-  for (it = (dg[v].vs).begin(); it != ((dg[v].vs).end() - 1); ++it)
-    name << g[*it].name << ", ";
+    for (const Graph::eDesc &e : Graph::getOutEdges(g, v)) {
+      // empty groupings are followed by the epsilon closure.
+      if (g[e].gp != emptyGrouping && els.count(g[e].gp))
+        buckets[g[e].gp].push_back(e);
+    }
 
-  name << g[*it].name << "}";
+    for (const std::pair<const groupingId, std::vector<Graph::eDesc>> &b : buckets) {
+      DG::Successor sc;
 
-  dg[v].name = name.str();
+      sc.gp = b.first;
+      sc.l  = g[b.second.front()].label;
 
-  return;
+      for (const Graph::eDesc &e : b.second)
+        sc.dsts |= closures[boost::target(e, g)];
+
+      succs[v].push_back(sc);
+    }
+  }
+
+  return succs;
 }
 
-DG::vDesc DG::addEmptyVertex(DG_t &dg, const edgeLabelSet &els)
+/**
+ * build the frozen out-edges and the transition table of dg. the edges are
+ * dropped from the adjacency lists, dg must not get new edges afterwards.
+ */
+void DG::freeze(DG_t &dg)
 {
-  DG::vDesc nv = boost::add_vertex(dg);
+  dgGraphProps &props = dg[boost::graph_bundle];
 
-  dg[nv].name = "{}";
-  dg[nv].role = "empty";
+  props.csr = Csr<dgEdgeProps>::freeze(dg, [&](const DG::eDesc &e) {
+    return dg[e];
+  });
 
-  DG::addSelfEdges(dg, nv, els);
+  props.delta = TransitionTable::build(props.csr, [](const dgEdgeProps &d) {
+    return d.gp;
+  });
 
-  return nv;
+  Util::dropEdges(dg);
 }
 
-void DG::addSelfEdges(DG_t &dg, const DG::vDesc &v, const edgeLabelSet &els)
+DG::Vertex DG::createVertex()
 {
-  std::vector<label> labels = Helper::elsFlatten(els);
-
-  for (const label &l : labels)
-    addEdge(dg, v, l, v);
+  DG::Vertex nv;
 
-  return;
+  return nv;
 }
 
-DG::eDesc DG::addEdge(DG_t &dg, const DG::vDesc &src, const label &l, const DG::vDesc &dst)
+/**
+ * vertex for the set of states vertices, an end state if any of them is final.
+ */
+DG::Vertex DG::createVertex(const Bitset &vertices, const Graph_t &g)
 {
-  DG::eDesc ne = boost::add_edge(src, dst, dg).first;
+  DG::Vertex nv;
 
-  dg[ne].label = l;
-  dg[ne].lowlink = "";
+  nv.vs.assign(vertices.begin(), vertices.end());
 
-  return ne;
+  if (vertices.intersects(g[boost::graph_bundle].finals))
+    nv.role = Role::end;
+
+  return nv;
 }
 
-DG::vDesc DG::addVertex(DG_t &dg, const DG::Vertex &v)
+DG::Vertex DG::createStart()
 {
-  DG::vDesc nv = boost::add_vertex(dg);
-
-  dg[nv].name = v.name;
-  dg[nv].role = v.role;
-  dg[nv].vs   = v.vs;
+  DG::Vertex nv;
+  nv.role = Role::start;
 
   return nv;
 }
 
-std::vector<Graph::eDesc> DG::getOutEdges(const DG_t &dg, const DG::vDesc &v, const Graph_t &g)
+DG::vDesc DG::getStart(const DG_t &dg)
 {
-  std::vector<Graph::eDesc> allOutEdges;
+  return dg[boost::graph_bundle].start;
+}
 
-  for (const DG::vDesc &gvd : dg[v].vs) {
-    Range<Graph::oeIter> outEdges = Graph::getOutEdges(g, gvd);
+bool DG::isFinalState(const DG_t &dg, const DG::vDesc &v)
+{
+  return dg[boost::graph_bundle].finals.test(v);
+}
 
-    for (const Graph::eDesc &oe : outEdges)
-      allOutEdges.push_back(oe);
+/**
+ * the vertex with the given name, see DG::getVertexName. it has to exist.
+ */
+DG::vDesc DG::getVertexByName(const DG_t &dg, const std::string &name)
+{
+  DG::vDesc res = boost::graph_traits<DG_t>::null_vertex();
+
+  const Range<DG::vIter> vertices = Util::makeRange(boost::vertices(dg));
 
+  for (const DG::vDesc &vd : vertices) {
+    if (DG::getVertexName(dg, vd) == name)
+      res =  vd;
   }
 
-  return allOutEdges;
-}
+  if (res == boost::graph_traits<DG_t>::null_vertex()) {
+    std::cout << "[Err] DG::getVertexByName // no vertex named " << name << std::endl;
+    exit(1);
+  }
 
-Range<DG::oeIter> DG::getOutEdges(const DG_t &g, const DG::vDesc &v)
-{
-  return Util::makeRange(boost::out_edges(v, g));
+  return res;
 }
 
-bool DG::hasEdgeForGrouping(const Graph_t &g, const std::vector<Graph::eDesc> &edges, const alignmentGrouping &gp, label& l)
+/**
+ * name of v for output, e.g. "{1, 4, 7}". rendered on demand from the state
+ * set, "{}" for the empty state.
+ */
+std::string DG::getVertexName(const DG_t &dg, const DG::vDesc &v)
 {
-  for (const Graph::eDesc &e : edges) {
-    if (g[e].gp == gp)
-    {
-      // we found the edge in g1/g2 that belongs to this alignment grouping.
-      // the edge in the corresponding dg1/dg2 will also only have one label
-      // as its label. we need to tell dg1/dg2 which of the labels in the
-      // alignment grouping originally created the grouping and use this as the
-      // edge's label.
-      // for example, consider from the paper example state II and edge x.
-      // this egde will have the alignment grouping {{s,w,x}}. in the
-      // determinized graph this edge will then also get label x.
-      l = g[e].label;
-
-      return true;
-    }
+  const std::vector<std::string> &srcNames = dg[boost::graph_bundle].srcNames;
+  std::stringstream name;
+  std::string sep = "";
+
+  name << "{";
+
+  for (const Graph::vDesc &gv : dg[v].vs) {
+    name << sep << srcNames[gv];
+    sep = ", ";
   }
 
-  return false;
+  name << "}";
+
+  return name.str();
 }
 
-std::vector<Graph::eDesc> DG::getEdgesForGrouping(const Graph_t &g, const std::vector<Graph::eDesc> &edges, const alignmentGrouping &gp)
+DG::eDesc DG::addEdge(DG_t &dg, const DG::vDesc &src, const label &l, const groupingId &gp, const DG::vDesc &dst)
 {
-  std::vector<Graph::eDesc> res;
+  DG::eDesc ne = boost::add_edge(src, dst, dg).first;
 
-  for (const Graph::eDesc &e : edges) {
-    if (g[e].gp == gp)
-      res.push_back(e);
-  }
+  dg[ne].label = l;
+  dg[ne].gp    = gp;
 
-  return res;
+  return ne;
 }
 
-DG::vDesc DG::getDst(const DG::vDesc &v, const std::string &l, const DG_t &g)
+DG::vDesc DG::addVertex(DG_t &dg, const DG::Vertex &v)
 {
-  DG::vDesc dst;
+  DG::vDesc nv = boost::add_vertex(dg);
+
+  dg[nv].role = v.role;
+  dg[nv].vs   = v.vs;
 
-  Range<DG::oeIter> oes = DG::getOutEdges(g, v);
+  if (Role::has(v.role, Role::start))
+    dg[boost::graph_bundle].start = nv;
 
-  for (const DG::eDesc &e : oes) {
-    if (g[e].label == l) {
-      dst = boost::target(e, g);
-      break;
-    }
-  }
+  if (Role::has(v.role, Role::end))
+    dg[boost::graph_bundle].finals.set(nv);
+
+  return nv;
+}
 
-  return dst;
+/**
+ * out-edges of v as indices into the frozen graph.
+ */
+DG::oeRange DG::getFrozenOutEdges(const DG_t &g, const DG::vDesc &v)
+{
+  return g[boost::graph_bundle].csr.outEdges(v);
+}
+
+/**
+ * destination of v for grouping gp, or TransitionTable::npos.
+ */
+DG::vDesc DG::getDst(const DG::vDesc &v, const groupingId &gp, const DG_t &g)
+{
+  return g[boost::graph_bundle].delta.dst(v, gp);
 }
 
 
@@ -336,18 +490,18 @@ void DG::print(const DG_t &g, std::ostream& target)
   Range<DG::vIter> vertices = Util::makeRange(boost::vertices(g));
 
   for (const DG::vDesc &v : vertices) {
-    if (g[v].role == "start") {
-      target << " \"" << g[v].name << "\" [role=\"start\"]" << std::endl;
+    if (Role::has(g[v].role, Role::start)) {
+      target << " \"" << DG::getVertexName(g, v) << "\" [role=\"start\"]" << std::endl;
       continue;
     }
 
-    if (g[v].role == "end") {
-      target << " \"" << g[v].name << "\" [role=\"end\"]" << std::endl;
+    if (Role::has(g[v].role, Role::end)) {
+      target << " \"" << DG::getVertexName(g, v) << "\" [role=\"end\"]" << std::endl;
       continue;
     }
 
-    if (g[v].role == "empty") {
-      target << " \"" << g[v].name << "\" [role=\"empty\"]" << std::endl;
+    if (Role::has(g[v].role, Role::empty)) {
+      target << " \"" << DG::getVertexName(g, v) << "\" [role=\"empty\"]" << std::endl;
       continue;
     }
   }
@@ -367,36 +521,36 @@ void DG::printVertices(const DG_t &g)
   const Range<DG::vIter> vertices = Util::makeRange(boost::vertices(g));
 
   for (const DG::vDesc &v : vertices)
-    std::cout << g[v].name << std::endl;
+    std::cout << DG::getVertexName(g, v) << std::endl;
 
   return;
 }
 
 void DG::printEdges(const DG_t &g)
 {
-  const Range<DG::eIter> edges = Util::makeRange(boost::edges(g));
+  const Csr<dgEdgeProps> &csr = g[boost::graph_bundle].csr;
 
-  for (const DG::eDesc &e : edges)
-    std::cout << g[e].label << std::endl;
+  for (std::size_t e = 0; e < csr.numEdges(); ++e)
+    std::cout << Lbl::name(csr.data(e).label) << std::endl;
 
   return;
 }
 
-void DG::printOutEdge(const DG_t &g, const eDesc &e)
+void DG::printOutEdge(const DG_t &g, const std::size_t &e)
 {
   return DG::printOutEdge(g, e, std::cout);
 }
-void DG::printOutEdge(const DG_t &g, const eDesc &e, std::ostream& target)
+void DG::printOutEdge(const DG_t &g, const std::size_t &e, std::ostream& target)
 {
-  const DG::vDesc src = boost::source(e, g);
-  const DG::vDesc dst = boost::target(e, g);
+  const Csr<dgEdgeProps> &csr = g[boost::graph_bundle].csr;
 
-  target << "  \"" << g[src].name << "\" -> \"" << g[dst].name << "\"";
+  const DG::vDesc src = csr.source(e);
+  const DG::vDesc dst = csr.target(e);
 
-  dgEdgeProps edge = g[e];
+  target << "  \"" << DG::getVertexName(g, src) << "\" -> \"" << DG::getVertexName(g, dst) << "\"";
 
-  target << " [label=\"" << g[e].label << "\"]" << std::endl;
-  // target << " [label=\"" << Alm::groupingToStr(g[e].gp) << "\"]" << std::endl;
+  target << " [label=\"" << Lbl::name(csr.data(e).label) << "\"]" << std::endl;
+  // target << " [label=\"" << Alm::groupingToStr(csr.data(e).gp) << "\"]" << std::endl;
 }
 
 void DG::printOutEdges(const DG_t &g, const DG::vDesc &vd)
@@ -405,12 +559,12 @@ void DG::printOutEdges(const DG_t &g, const DG::vDesc &vd)
 }
 void DG::printOutEdges(const DG_t &g, const DG::vDesc &vd, std::ostream& target)
 {
-  const Range<DG::oeIter> outEdges = Util::makeRange(boost::out_edges(vd, g));
+  const DG::oeRange outEdges = DG::getFrozenOutEdges(g, vd);
 
   if (outEdges.empty())
     return;
 
-  for (const DG::eDesc &e : outEdges)
+  for (const std::size_t &e : outEdges)
     DG::printOutEdge(g, e, target);
 
   return;
@@ -2,224 +2,148 @@
 #include <string>
 
 #include "DetWitnessUtils.hpp"
+#include "SubsetConstruction.hpp"
 #include "WitnessUtils.hpp"
 
 #include "Logging.hpp"
 
-DWG_t DWG::createLhs(const WG_t &wg, const edgeLabelSet &els)
+/**
+ * the transition table is filled by addEdge, it covers the groupings of els.
+ */
+template <typename Side, typename Source>
+DWG::Builder<Side, Source>::Builder(DWG_t &dwg, Source &source, const edgeLabelSet &els)
+  : dwg(dwg), source(source), width(els.empty() ? 0 : *els.rbegin() + 1), inEls(width, false)
 {
-  DWG_t dwg;
-  DWG::vDesc dwgEmpty = DWG::addEmptyVertex(dwg, els);
-
-  DWG::Vertex dwgStart = DWG::createVertex("", "start");
-  WG::vDesc wgStart = WG::getStart(wg);
-
-  DWG::addVertexToSet(dwgStart, wgStart, wg);
-  DWG::addVertex(dwg, dwgStart, wg);
-
-  std::deque<DWG::Vertex> dwgTodo;
-
-  dwgTodo.push_back(dwgStart);
-
-  while (!dwgTodo.empty()) {
-
-    DWG::Vertex currV = dwgTodo.front();
-
-    DWG::vDesc dwgv1 = DWG::getVertex(currV, dwg);
-    dwgTodo.pop_front();
-
-    DEBUG << "checking node: " << dwg[dwgv1].name << std::endl;
-
-    std::vector<WG::eDesc> oedges = DWG::getOutEdges(dwg, wg, dwgv1);
-
-    DEBUG << "  out edges:\n";
-
-    for (const WG::eDesc &e : oedges)
-      WG::printOutEdgeDebug(wg, e);
-
-    Util::printLineDebug();
-
-
-    for (const alignmentGrouping &gp : els) {
-
-      DEBUG << "  grouping " << Alm::groupingToStr(gp) << ":\n";
-
-      if (!WG::hasEdgeLhs(oedges, gp, wg)) {
-        DEBUG << "    no edge for label, adding edge to empty state\n\n\n";
-
-        DWG::addEdge(dwgv1, gp, dwgEmpty, dwg);
-        continue;
-      }
-      DEBUG << "    has edge for label\n";
-
-      std::vector<WG::eDesc> edges = WG::getEdgesWithLabelLhs(oedges, gp, wg);
-      std::vector<WG::vDesc> dsts  = WG::getDestinations(edges, wg);
-
-      DEBUG << "    label: " << Alm::groupingToStr(gp) << "\n";
-      DEBUG << "    edges:\n";
-      for (const WG::eDesc &e : edges)
-        WG::printOutEdgeDebug(wg, e);
-
-      IF_DEBUG(
-        DEBUG << "    destinations:\n";
-
-        for (const WG::vDesc &v : dsts)
-          DEBUG << wg[v].name << "\n";
-
-        DEBUG << "    dsts are sub: " << DWG::destinationsAreSubset(dsts, DWG::getVertex(dwgv1, dwg)) << "\n";
-      )
-
-      if (DWG::destinationsAreSubset(dsts, DWG::getVertex(dwgv1, dwg))) {
-        DEBUG << "    destinations are subset of myself, adding self-edge\n\n\n";
-        DWG::addEdge(dwgv1, gp, dwgv1, dwg);
-        continue;
-      }
-
-      DWG::Vertex nv = DWG::createVertex();
-
-      for (const WG::vDesc &dst : dsts)
-        DWG::addVertexToSet(nv, dst, wg);
-
-      DWG::findAllNodesLhs(nv, wg);
-      DWG::setFinalState(nv, wg);
-
-      DEBUG << "    current vertex: " << nv.name << " role: " << nv.role << "\n";
-
-      if (DWG::hasVertex(nv, dwg)) {
-        DEBUG << "    vertex already exists, only adding edge\n\n\n";
-        DWG::vDesc dwgv2 = DWG::getVertex(nv, dwg);
-        DWG::addEdge(dwgv1, gp, dwgv2, dwg);
-        continue;
-      }
-
-      DEBUG << "    vertex is new, adding vertex, edge and todo\n\n\n";
-      DWG::vDesc dwgv2 = DWG::addVertex(dwg, nv, wg);
-      DWG::addEdge(dwgv1, gp, dwgv2, dwg);
-
-      dwgTodo.push_back(DWG::getVertex(dwgv2, dwg));
+  for (const groupingId &gp : els)
+    inEls[gp] = true;
 
+  dwg[boost::graph_bundle].delta = TransitionTable(width);
+}
 
-    } // label loop
+template <typename Side, typename Source>
+std::vector<WG::vDesc> DWG::Builder<Side, Source>::start() const
+{
+  return set_t(1, WG::getStart(source.graph()));
+}
 
-    DEBUG << "\nTodo:\n";
+/**
+ * the start state is not closed and never final.
+ */
+template <typename Side, typename Source>
+std::size_t DWG::Builder<Side, Source>::add(const set_t &s, const bool &isStart)
+{
+  DWG::Vertex nv = DWG::createVertex(isStart ? Role::start : Role::none);
+  nv.vs = s;
 
-    for (const DWG::Vertex &v : dwgTodo)
-      DEBUG << v.name << std::endl;
+  if (!isStart)
+    DWG::setFinalState(nv, source.graph());
 
-    Util::printLineDebug();
-    Util::printLineDebug();
-    Util::printLineDebug();
-  } // todo loop
+  IF_DEBUG(
+    DEBUG << "    new vertex: {";
+    for (const WG::vDesc &v : nv.vs)
+      DEBUG << " " << v;
+    DEBUG << " } role: " << Role::toString(nv.role) << "\n";
+  )
 
-  return dwg;
+  return DWG::addVertex(dwg, nv);
 }
 
-DWG_t DWG::createRhs(const WG_t &wg, const edgeLabelSet &els)
+template <typename Side, typename Source>
+const std::vector<WG::vDesc> &DWG::Builder<Side, Source>::get(const std::size_t &v) const
 {
-  DWG_t dwg;
-  DWG::vDesc dwgEmpty = DWG::addEmptyVertex(dwg, els);
-
-  DWG::Vertex dwgStart = DWG::createVertex("", "start");
-  WG::vDesc wgStart = WG::getStart(wg);
-
-  DWG::addVertexToSet(dwgStart, wgStart, wg);
-  DWG::addVertex(dwg, dwgStart, wg);
+  return DWG::getVertexSet(v, dwg);
+}
 
-  std::deque<DWG::Vertex> dwgTodo;
-  std::vector<DWG::vDesc> visited;
+template <typename Side, typename Source>
+std::size_t DWG::Builder<Side, Source>::hash(const set_t &s) const
+{
+  return DWG::hashVertexSet(s);
+}
 
-  dwgTodo.push_back(dwgStart);
+template <typename Side, typename Source>
+HashIndex &DWG::Builder<Side, Source>::index()
+{
+  return dwg[boost::graph_bundle].index;
+}
 
-  while (!dwgTodo.empty()) {
+template <typename Side, typename Source>
+void DWG::Builder<Side, Source>::expand(const std::size_t &v, std::vector<std::pair<edge_t, set_t>> &succs)
+{
+  DEBUG << "checking node: " << v << std::endl;
 
-    DWG::Vertex currV = dwgTodo.front();
+  // the out-edges of the members have to be known before they are read.
+  for (const WG::vDesc &wgv : DWG::getVertexSet(v, dwg))
+    source.expand(wgv);
 
-    DWG::vDesc dwgv1 = DWG::getVertex(currV, dwg);
-    dwgTodo.pop_front();
+  const WG_t &wg = source.graph();
 
-    DEBUG << "checking node: " << dwg[dwgv1].name << std::endl;
+  DWG::vDesc curr = v;
+  std::vector<WG::eIndex> oedges = DWG::getOutEdges(dwg, wg, curr);
 
-    std::vector<WG::eDesc> oedges = DWG::getOutEdges(dwg, wg, dwgv1);
+  IF_DEBUG(
     DEBUG << "  out edges:\n";
 
-    for (const WG::eDesc &e : oedges)
+    for (const WG::eIndex &e : oedges)
       WG::printOutEdgeDebug(wg, e);
+  )
 
-    Util::printLineDebug();
-
-
-    for (const alignmentGrouping &gp : els) {
-
-      DEBUG << "  grouping " << Alm::groupingToStr(gp) << ":\n";
-
-      if (!WG::hasEdgeRhs(oedges, gp, wg)) {
-        DEBUG << "    no edge for label, adding edge to empty state\n\n\n";
-        DWG::addEdge(dwgv1, gp, dwgEmpty, dwg);
-        continue;
-      }
-      DEBUG << "    has edge for label\n";
-
-      std::vector<WG::eDesc> edges = WG::getEdgesWithLabelRhs(oedges, gp, wg);
-      std::vector<WG::vDesc> dsts  = WG::getDestinations(edges, wg);
+  WG::bucket<Side>(oedges, width, wg, buckets);
 
-      DEBUG << "    label: " << Alm::groupingToStr(gp) << "\n";
-      DEBUG << "    edges:\n";
-      for (const WG::eDesc &e : edges)
-        WG::printOutEdgeDebug(wg, e);
-
-      IF_DEBUG(
-        DEBUG << "    destinations:\n";
-        for (const WG::vDesc &v : dsts)
-          DEBUG << wg[v].name << "\n";
-        DEBUG << "    dsts are sub: " << DWG::destinationsAreSubset(dsts, DWG::getVertex(dwgv1, dwg)) << "\n";
-      )
-
-      if (DWG::destinationsAreSubset(dsts, DWG::getVertex(dwgv1, dwg))) {
-        DEBUG << "    destinations are subset of myself, adding self-edge\n\n\n";
-        DWG::addEdge(dwgv1, gp, dwgv1, dwg);
-        continue;
-      }
+  // groupings without an edge lead to DWG::dead, only the non-empty buckets
+  // are visited.
+  for (const groupingId &gp : buckets.groupings) {
+    if (!inEls[gp])
+      continue;
 
-      DWG::Vertex nv = DWG::createVertex();
+    DEBUG << "  grouping " << "#" << gp << ":\n";
 
-      for (const WG::vDesc &dst : dsts)
-        DWG::addVertexToSet(nv, dst, wg);
+    std::vector<WG::vDesc> dsts = WG::getDestinations(WG::getBucket(buckets, gp), wg);
 
-      DWG::findAllNodesRhs(nv, wg);
-      DWG::setFinalState(nv, wg);
+    succs.push_back(std::make_pair(gp, source.closure(dsts)));
+  }
 
-      DEBUG << "    current vertex: " << nv.name << " role: " << nv.role << "\n";
+  Util::printLineDebug();
+}
 
-      if (DWG::hasVertex(nv, dwg)) {
-        DEBUG << "    vertex already exists, only adding edge\n\n\n";
-        DWG::vDesc dwgv2 = DWG::getVertex(nv, dwg);
-        DWG::addEdge(dwgv1, gp, dwgv2, dwg);
-        continue;
-      }
+template <typename Side, typename Source>
+void DWG::Builder<Side, Source>::addEdge(const std::size_t &v, const edge_t &gp, const std::size_t &dst)
+{
+  DWG::vDesc src = v;
+  DWG::vDesc tgt = dst;
 
-      DEBUG << "    vertex is new, adding vertex, edge and todo\n\n\n";
-      DWG::vDesc dwgv2 = DWG::addVertex(dwg, nv, wg);
-      DWG::addEdge(dwgv1, gp, dwgv2, dwg);
+  DWG::addEdge(src, gp, tgt, dwg);
+  dwg[boost::graph_bundle].delta.add(v, gp, dst);
+}
 
-      dwgTodo.push_back(DWG::getVertex(dwgv2, dwg));
+template class DWG::Builder<WG::Lhs, WG::Frozen<WG::Lhs>>;
+template class DWG::Builder<WG::Rhs, WG::Frozen<WG::Rhs>>;
+template class DWG::Builder<WG::Lhs, WG::OnDemand<WG::Lhs>>;
+template class DWG::Builder<WG::Rhs, WG::OnDemand<WG::Rhs>>;
 
+namespace {
+  template <typename Side>
+  DWG_t create(const WG_t &wg, const edgeLabelSet &els)
+  {
+    DWG_t dwg;
 
-    } // label loop
+    WG::Frozen<Side> source(wg);
+    DWG::Builder<Side> b(dwg, source, els);
+    Subset::construct(b);
 
-    //DWG::print(dwg, wg);
+    DWG::freeze(dwg);
 
-    IF_DEBUG(
-      DEBUG << "\nTodo:\n";
-      for (const DWG::Vertex &v : dwgTodo)
-        DEBUG << v.name << std::endl;
-    )
+    return dwg;
+  }
+}
 
-    Util::printLineDebug();
-    Util::printLineDebug();
-    Util::printLineDebug();
-  } // todo loop
+DWG_t DWG::createLhs(const WG_t &wg, const edgeLabelSet &els)
+{
+  return create<WG::Lhs>(wg, els);
+}
 
-  return dwg;
+DWG_t DWG::createRhs(const WG_t &wg, const edgeLabelSet &els)
+{
+  return create<WG::Rhs>(wg, els);
 }
 
 DWG::Vertex DWG::createVertex()
@@ -229,90 +153,85 @@ DWG::Vertex DWG::createVertex()
   return nv;
 }
 
-DWG::Vertex DWG::createVertex(const std::string &name, const std::string &role)
+DWG::Vertex DWG::createVertex(const vertexRole &role)
 {
   DWG::Vertex nv;
 
-  nv.name = name;
   nv.role = role;
 
   return nv;
 }
 
-void DWG::addVertexToSet(DWG::Vertex &dwgv, const WG::vDesc wgv, const WG_t &wg)
+/**
+ * insert wgv into the sorted state set of dwgv.
+ */
+void DWG::addVertexToSet(DWG::Vertex &dwgv, const WG::vDesc wgv)
 {
-  if (DWG::vertexHasVertex(dwgv, wgv))
+  std::vector<WG::vDesc>::iterator it = std::lower_bound(dwgv.vs.begin(), dwgv.vs.end(), wgv);
+
+  if (it != dwgv.vs.end() && *it == wgv)
     return;
 
-  dwgv.vs.push_back(wgv);
-  std::sort(dwgv.vs.begin(), dwgv.vs.end());
-  DWG::updateVertexName(dwgv, wg);
+  dwgv.vs.insert(it, wgv);
 
   return;
 }
 
-void DWG::addVertexToSet(DWG_t &dwg, DWG::vDesc &dwgv, const WG::vDesc wgv, const WG_t & wg)
-{
-  (dwg[dwgv].vs).push_back(wgv);
-  std::sort((dwg[dwgv].vs).begin(), (dwg[dwgv].vs).end());
-  DWG::updateVertexName(dwgv, dwg, wg);
-
-  return;
-}
-
-void DWG::updateVertexName(const DWG::vDesc &dwgv, DWG_t &dwg, const WG_t &wg)
+/**
+ * name of v for output, the names of the witness graph vertices it contains.
+ * rendered on demand, these names grow large quickly.
+ */
+std::string DWG::getVertexName(const DWG_t &dwg, const DWG::vDesc &v, const WG_t &wg, const DG_t &g1, const DG_t &g2)
 {
   std::stringstream name;
-  name << "{";
-
-  std::vector<WG::vDesc>::iterator it;
-
-  for (it = dwg[dwgv].vs.begin(); it != (dwg[dwgv].vs.end() - 1); ++it)
-    name << "(" << wg[*it].name << "), ";
-
-  name << "(" << wg[*it].name << ")";
-  name << "}";
+  std::string sep = "";
 
-  dwg[dwgv].name = name.str();
-
-  return;
-}
-
-void DWG::updateVertexName(DWG::Vertex &dwgv, const WG_t &wg)
-{
-  std::stringstream name;
   name << "{";
 
-  std::vector<WG::vDesc>::iterator it;
-
-  for (it = dwgv.vs.begin(); it != (dwgv.vs.end() - 1); ++it)
-    name << "(" << wg[*it].name << "), ";
+  for (const WG::vDesc &wgv : dwg[v].vs) {
+    name << sep << "(" << WG::getVertexName(wg, wgv, g1, g2) << ")";
+    sep = ", ";
+  }
 
-  name << "(" << wg[*it].name << ")";
   name << "}";
 
-  dwgv.name = name.str();
+  return name.str();
 }
 
-DWG::vDesc DWG::addVertex(DWG_t &dwg, const DWG::Vertex &v, const WG_t &wg)
+DWG::vDesc DWG::addVertex(DWG_t &dwg, const DWG::Vertex &v)
 {
   DWG::vDesc nv = boost::add_vertex(dwg);
 
   dwg[nv].role = v.role;
   dwg[nv].vs   = v.vs;
 
-  DWG::updateVertexName(nv, dwg, wg);
+  if (Role::has(v.role, Role::start))
+    dwg[boost::graph_bundle].start = nv;
+
+  if (Role::has(v.role, Role::end))
+    dwg[boost::graph_bundle].finals.set(nv);
 
   return nv;
 }
 
-DWG::eDesc DWG::addEdge(DWG::vDesc &v1, const alignmentGrouping &gp, DWG::vDesc &v2, DWG_t &dwg)
+/**
+ * build the frozen out-edges of dwg, the transition table is complete
+ * already. the edges are dropped from the adjacency lists, dwg must not get
+ * new edges afterwards.
+ */
+void DWG::freeze(DWG_t &dwg)
 {
-  DWG::eDesc e = boost::add_edge(v1, v2, dwg).first;
+  dwg[boost::graph_bundle].csr = Csr<groupingId>::freeze(dwg, [&](const DWG::eDesc &e) {
+    return dwg[e].gp;
+  });
 
-  std::string name = Alm::groupingToStr(gp);
+  Util::dropEdges(dwg);
+}
+
+DWG::eDesc DWG::addEdge(DWG::vDesc &v1, const groupingId &gp, DWG::vDesc &v2, DWG_t &dwg)
+{
+  DWG::eDesc e = boost::add_edge(v1, v2, dwg).first;
 
-  dwg[e].name = name;
   dwg[e].gp = gp;
 
   return e;
@@ -322,79 +241,75 @@ DWG::Vertex DWG::getVertex(const DWG::vDesc &v, const DWG_t &dwg)
 {
   DWG::Vertex nv;
 
-  nv.name = dwg[v].name;
   nv.role = dwg[v].role;
   nv.vs   = dwg[v].vs;
 
   return nv;
 }
 
-DWG::vDesc DWG::getVertex(const DWG::Vertex &v, const DWG_t &dwg)
+/**
+ * descriptor of the vertex with the same state set as v, or HashIndex::npos.
+ */
+DWG::vDesc DWG::findVertex(const DWG::Vertex &v, const DWG_t &dwg)
 {
-  DWG::vDesc nv;
-
-  Range<DWG::vIter> vertices = Util::makeRange(boost::vertices(dwg));
+  return dwg[boost::graph_bundle].index.find(DWG::hashVertexSet(v.vs), [&](const std::size_t &dwgv) {
+    return dwg[dwgv].vs == v.vs;
+  });
+}
 
-  for (const DWG::vDesc &dwgv : vertices) {
-    if (dwg[dwgv].name == v.name)
-      nv = dwgv;
-  }
+/**
+ * the sorted set of witness graph vertices v stands for, without copying it.
+ */
+const std::vector<WG::vDesc> &DWG::getVertexSet(const DWG::vDesc &v, const DWG_t &dwg)
+{
+  return dwg[v].vs;
+}
 
-  return nv;
+std::size_t DWG::hashVertexSet(const std::vector<WG::vDesc> &vs)
+{
+  return HashIndex::hash(vs.begin(), vs.end());
 }
 
 DWG::vDesc DWG::getStart(const DWG_t &dwg)
 {
-  DWG::vDesc start;
-  const Range<DWG::vIter> vertices = Util::makeRange(boost::vertices(dwg));
-
-  for (const DWG::vDesc &v : vertices) {
-    if (dwg[v].role == "start")
-      start = v;
-  }
-
-  return start;
+  return dwg[boost::graph_bundle].start;
 }
 
-
-DWG::vDesc DWG::getDst(const DWG::vDesc &v, const alignmentGrouping &gp, const DWG_t &dwg)
+bool DWG::isFinalState(const DWG_t &dwg, const DWG::vDesc &v)
 {
-  DWG::vDesc dst;
+  return v != DWG::dead && dwg[boost::graph_bundle].finals.test(v);
+}
 
-  Range<DWG::oeIter> oes = Util::makeRange(boost::out_edges(v, dwg));
 
-  for (const DWG::eDesc &e : oes) {
-    if (dwg[e].gp == gp) {
-      dst = boost::target(e, dwg);
-      break;
-    }
-  }
+/**
+ * destination of v for grouping gp, DWG::dead if v has no such edge.
+ */
+DWG::vDesc DWG::getDst(const DWG::vDesc &v, const groupingId &gp, const DWG_t &dwg)
+{
+  if (v == DWG::dead)
+    return DWG::dead;
 
-  return dst;
+  return dwg[boost::graph_bundle].delta.dst(v, gp);
 }
 
-std::vector<WG::eDesc> DWG::getOutEdges(const DWG::Vertex &v, const WG_t &wg)
+std::vector<WG::eIndex> DWG::getOutEdges(const DWG::Vertex &v, const WG_t &wg)
 {
-  std::vector<WG::eDesc> oedges;
+  std::vector<WG::eIndex> oedges;
 
   for (const WG::vDesc &wgv : v.vs) {
-    Range<WG::oeIter> oes = Util::makeRange(boost::out_edges(wgv, wg));
-
-    for (const WG::eDesc &e : oes)
+    for (const WG::eIndex &e : WG::getOutEdges(wg, wgv))
       oedges.push_back(e);
   }
 
   return oedges;
 }
 
-std::vector<WG::eDesc> DWG::getOutEdges(const DWG_t & dwg, const WG_t &wg, const DWG::vDesc &v)
+std::vector<WG::eIndex> DWG::getOutEdges(const DWG_t & dwg, const WG_t &wg, const DWG::vDesc &v)
 {
-  std::vector<WG::eDesc> oedges;
+  std::vector<WG::eIndex> oedges;
 
   for (const WG::vDesc &wgv : dwg[v].vs) {
-    Range<WG::oeIter> oes = Util::makeRange(boost::out_edges(wgv, wg));
-
-    for (const WG::eDesc &e : oes)
+    for (const WG::eIndex &e : WG::getOutEdges(wg, wgv))
       oedges.push_back(e);
   }
 
@@ -403,248 +318,20 @@ std::vector<WG::eDesc> DWG::getOutEdges(const DWG_t & dwg, const WG_t &wg, const
 
 bool DWG::hasVertex(const DWG::Vertex &v, const DWG_t &dwg)
 {
-
-  Range<DWG::vIter> vertices = Util::makeRange(boost::vertices(dwg));
-
-  for (const DWG::vDesc &dwgv : vertices) {
-    if (dwg[dwgv].name == v.name)
-      return true;
-  }
-
-  return false;
+  return DWG::findVertex(v, dwg) != HashIndex::npos;
 }
 
 bool DWG::vertexHasVertex(const DWG::Vertex &dwgv, const WG::vDesc &wgv)
 {
-  return (std::find(dwgv.vs.begin(), dwgv.vs.end(), wgv) != dwgv.vs.end());
-}
-
-DWG::vDesc DWG::addEmptyVertex(DWG_t &dwg, const edgeLabelSet &els)
-{
-  DWG::vDesc nv = boost::add_vertex(dwg);
-
-  dwg[nv].name = "{}";
-  dwg[nv].role = "empty";
-
-  for (const alignmentGrouping &gp : els)
-    DWG::addEdge(nv, gp, nv, dwg);
-
-  return nv;
+  return std::binary_search(dwgv.vs.begin(), dwgv.vs.end(), wgv);
 }
 
 
-bool DWG::hasVertexThatContains(const WG::vDesc &v, const DWG_t &dwg)
-{
-  Range<DWG::vIter> vertices = Util::makeRange(boost::vertices(dwg));
-
-  for (const DWG::vDesc &dwgv : vertices) {
-    if (DWG::vertexHasVertex(DWG::getVertex(dwgv, dwg), v))
-      return true;
-  }
-
-  return false;
-}
-
-
-DWG::vDesc DWG::getVertexThatContains(const WG::vDesc &wgv, const DWG_t &dwg)
-{
-  DWG::vDesc res;
-
-  Range<DWG::vIter> vertices = Util::makeRange(boost::vertices(dwg));
-
-  for (const DWG::vDesc &dwgv : vertices) {
-    if (DWG::vertexHasVertex(DWG::getVertex(dwgv, dwg), wgv)) {
-      res = dwgv;
-      break;
-    }
-  }
-
-  return res;
-}
-
-bool DWG::alreadyVisited(const std::vector<WG::vDesc> &vs, const WG::vDesc &t)
-{
-  return (std::find(vs.begin(), vs.end(), t) != vs.end());
-}
-
-bool DWG::alreadyContained(const DWG::Vertex &v, const WG::vDesc &nv)
-{
-  return (std::find(v.vs.begin(), v.vs.end(), nv) != v.vs.end());
-}
-
-bool DWG::destinationsAreSubset(const std::vector<WG::vDesc> dsts, const DWG::Vertex &v)
-{
-  for (const WG::vDesc &dst : dsts) {
-    if (std::find(v.vs.begin(), v.vs.end(), dst) == v.vs.end())
-      return false;
-  }
-
-  return true;
-}
-
-void DWG::findAllNodesLhs(DWG::Vertex &v, const WG_t &wg)
-{
-  // fill a queue with the vectors in v.vs and then iterate over them
-  // we need the queue because inside the loop we may append new vectors
-  // to v.vs, thereby invalidating any iterator.
-  std::deque<WG::vDesc> vectors;
-  for (const auto &start : v.vs) {
-    vectors.push_back(start);
-  }
-
-  while(!vectors.empty())
-  {
-    auto start = vectors.front();
-    vectors.pop_front();
-
-    DEBUG << "[findAllNodes] start at " << wg[start].name << "\n";
-
-    std::deque<WG::vDesc> todo;
-    std::vector<WG::vDesc> visited;
-
-    todo.push_back(start);
-
-    while (!todo.empty()) {
-
-      WG::vDesc curr = todo.front();
-      todo.pop_front();
-      visited.push_back(curr);
-
-      DEBUG << "  [findAllNodes] checking node " << wg[curr].name << " (" << curr << ")\n";
-
-      Range<WG::oeIter> oedges = Util::makeRange(boost::out_edges(curr, wg));
-
-      if (oedges.empty()) {
-        DEBUG << "  [findAllNodes] no out edges, done.\n";
-        continue;
-      }
-
-      DEBUG << "  [findAllNodes] out edges:\n";
-      for (const WG::eDesc &e : oedges)
-        WG::printOutEdgeDebug(wg, e);
-
-      if (!WG::hasEmptyTransitionLhs(oedges, wg)) {
-        DEBUG << "  [findAllNodes] no empty edge\n";
-        continue;
-      }
-
-      std::vector<WG::eDesc> empties = WG::getEmptyEdgesLhs(oedges, wg);
-      DEBUG << "  [findAllNodes] empty edges:\n";
-      for (const WG::eDesc &e : empties)
-        WG::printOutEdgeDebug(wg, e);
-
-      for (const WG::eDesc &e : empties) {
-        WG::vDesc nv = boost::target(e, wg);
-        DEBUG << "    [findAllNodes] checking dst " << wg[nv].name << "\n";
-
-        if (DWG::alreadyVisited(visited, nv)) {
-          DEBUG << "    [findAllNodes] already visited\n";
-          continue;
-        }
-
-        if (DWG::vertexHasVertex(v, nv)) {
-          DEBUG << "    [findAllNodes] already contained\n";
-          continue;
-        }
-
-        DEBUG << "    [findAllNodes] not visited, not contained -> adding node " << wg[nv].name << "\n";
-
-        DWG::addVertexToSet(v, nv, wg);
-        todo.push_back(nv);
-      }
-    }
-  }
-
-  DEBUG << "[findAllNodes] done.\n\n";
-
-  return;
-}
-
-void DWG::findAllNodesRhs(DWG::Vertex &v, const WG_t &wg)
-{
-  // fill a queue with the vectors in v.vs and then iterate over them
-  // we need the queue because inside the loop we may append new vectors
-  // to v.vs, thereby invalidating any iterator.
-  std::deque<WG::vDesc> vectors;
-  for (const auto &start : v.vs) {
-    vectors.push_back(start);
-  }
-
-  while(!vectors.empty())
-  {
-    auto start = vectors.front();
-    vectors.pop_front();
-
-    DEBUG << "[findAllNodes] start at " << wg[start].name << "\n";
-
-    std::deque<WG::vDesc> todo;
-    std::vector<WG::vDesc> visited;
-
-    todo.push_back(start);
-
-    while (!todo.empty()) {
-
-      WG::vDesc curr = todo.front();
-      todo.pop_front();
-      visited.push_back(curr);
-
-      DEBUG << "  [findAllNodes] checking node " << wg[curr].name << " (" << curr << ")\n";
-
-      Range<WG::oeIter> oedges = Util::makeRange(boost::out_edges(curr, wg));
-
-      if (oedges.empty()) {
-        DEBUG << "  [findAllNodes] no out edges, done.\n";
-        continue;
-      }
-
-      IF_DEBUG(
-        DEBUG << "  [findAllNodes] out edges:\n";
-        for (const WG::eDesc &e : oedges)
-          WG::printOutEdgeDebug(wg, e);
-      );
-
-      if (!WG::hasEmptyTransitionRhs(oedges, wg)) {
-        DEBUG << "  [findAllNodes] no empty edge\n";
-        continue;
-      }
-
-      std::vector<WG::eDesc> empties = WG::getEmptyEdgesRhs(oedges, wg);
-      DEBUG << "  [findAllNodes] empty edges:\n";
-      for (const WG::eDesc &e : empties)
-        WG::printOutEdgeDebug(wg, e);
-
-      for (const WG::eDesc &e : empties) {
-        WG::vDesc nv = boost::target(e, wg);
-        DEBUG << "    [findAllNodes] checking dst " << wg[nv].name << "\n";
-
-        if (DWG::alreadyVisited(visited, nv)) {
-          DEBUG << "    [findAllNodes] already visited\n";
-          continue;
-        }
-
-        if (DWG::vertexHasVertex(v, nv)) {
-          DEBUG << "    [findAllNodes] already contained\n";
-          continue;
-        }
-
-        DEBUG << "    [findAllNodes] not visited, not contained -> adding node " << wg[nv].name << "\n";
-
-        DWG::addVertexToSet(v, nv, wg);
-        todo.push_back(nv);
-      }
-    }
-  }
-
-  DEBUG << "[findAllNodes] done.\n\n";
-
-  return;
-}
-
 void DWG::setFinalState(DWG::Vertex &v, const WG_t &wg)
 {
   for (const WG::vDesc &vd : v.vs) {
-    if (wg[vd].role == "end") {
-      v.role = "end";
+    if (WG::isFinalState(wg, vd)) {
+      v.role = Role::end;
       return;
     }
   }
@@ -681,12 +368,15 @@ void DWG::setFinalState(DWG::Vertex &v, const WG_t &wg)
 
 
 
-void DWG::printOutEdge(const DWG::eDesc &e, const DWG_t &dwg)
+void DWG::printOutEdge(const std::size_t &e, const DWG_t &dwg, const WG_t &wg, const DG_t &g1, const DG_t &g2,
+                       const groupingTable &gt)
 {
-  const DWG::vDesc src = boost::source(e, dwg);
-  const DWG::vDesc dst = boost::target(e, dwg);
+  const Csr<groupingId> &csr = dwg[boost::graph_bundle].csr;
+
+  const DWG::vDesc src = csr.source(e);
+  const DWG::vDesc dst = csr.target(e);
 
-  std::string gp = Alm::groupingToStr(dwg[e].gp);
+  std::string gp = Alm::groupingToStr(gt, csr.data(e));
 
   std::stringstream label;
 
@@ -699,22 +389,23 @@ void DWG::printOutEdge(const DWG::eDesc &e, const DWG_t &dwg)
 
   label << "}";
 
-  std::cout << "  \"" << dwg[src].name << "\" ->  \"" << dwg[dst].name << "\"";
+  std::cout << "  \"" << DWG::getVertexName(dwg, src, wg, g1, g2) << "\" ->  \"" << DWG::getVertexName(dwg, dst, wg, g1, g2) << "\"";
   std::cout << " [label=\"" << label.str() << "\", gp=\"" << gp << "\"]" << std::endl;
 
   return;
 }
 
 
-void DWG::printOutEdges(const DWG::vDesc &v, const DWG_t &dwg)
+void DWG::printOutEdges(const DWG::vDesc &v, const DWG_t &dwg, const WG_t &wg, const DG_t &g1, const DG_t &g2,
+                        const groupingTable &gt)
 {
-  Range<DWG::oeIter> oedges = Util::makeRange(boost::out_edges(v, dwg));
+  const Csr<groupingId>::edgeRange oedges = dwg[boost::graph_bundle].csr.outEdges(v);
 
   if (oedges.empty())
     return;
 
-  for (const DWG::eDesc &e : oedges)
-    printOutEdge(e, dwg);
+  for (const std::size_t &e : oedges)
+    printOutEdge(e, dwg, wg, g1, g2, gt);
 
   Util::printLine();
 
@@ -722,7 +413,10 @@ void DWG::printOutEdges(const DWG::vDesc &v, const DWG_t &dwg)
 
 }
 
-void DWG::print(const DWG_t &dwg)
+/**
+ * moves to DWG::dead are not stored, so they are not printed either.
+ */
+void DWG::print(const DWG_t &dwg, const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt)
 {
 
   std::cout << "digraph {" << std::endl;
@@ -731,13 +425,13 @@ void DWG::print(const DWG_t &dwg)
 
   for (const DWG::vDesc &v : vertices) {
 
-    if (dwg[v].role == "start") {
-      std::cout << "  \"" << dwg[v].name << "\" [role=\"start\"]" << std::endl;
+    if (Role::has(dwg[v].role, Role::start)) {
+      std::cout << "  \"" << DWG::getVertexName(dwg, v, wg, g1, g2) << "\" [role=\"start\"]" << std::endl;
       continue;
     }
 
-    if (dwg[v].role == "end") {
-      std::cout << "  \"" << dwg[v].name << "\" [role=\"end\"]" << std::endl;
+    if (Role::has(dwg[v].role, Role::end)) {
+      std::cout << "  \"" << DWG::getVertexName(dwg, v, wg, g1, g2) << "\" [role=\"end\"]" << std::endl;
       continue;
     }
   }
@@ -745,7 +439,7 @@ void DWG::print(const DWG_t &dwg)
   Util::printLine();
 
   for (const WG::vDesc &v : vertices)
-    DWG::printOutEdges(v, dwg);
+    DWG::printOutEdges(v, dwg, wg, g1, g2, gt);
 
   std::cout << "}" << std::endl;
 
@@ -1,12 +1,62 @@
+#include <algorithm>
 #include <iostream>
 #include <sstream>
-#include <deque>
-#include <unordered_map>
+#include <map>
+#include <set>
 
 #include "GraphUtils.hpp"
+#include "Scc.hpp"
 #include "Utils.hpp"
 
 
+/**
+ * Write-through property map for the graphviz reader: edge labels are interned
+ * into the label table as they are read, so EdgeProps only stores label ids.
+ */
+struct labelInternMap {
+  using key_type   = Graph::eDesc;
+  using value_type = std::string;
+  using reference  = std::string;
+  using category   = boost::read_write_property_map_tag;
+
+  Graph_t *g;
+};
+
+std::string get(const labelInternMap &m, const Graph::eDesc &e)
+{
+  return Lbl::name((*m.g)[e].label);
+}
+
+void put(const labelInternMap &m, const Graph::eDesc &e, const std::string &l)
+{
+  (*m.g)[e].label = Lbl::intern(l);
+}
+
+
+/**
+ * Write-through property map for the graphviz reader: the role attribute is
+ * parsed into role flags as it is read.
+ */
+struct roleMap {
+  using key_type   = Graph::vDesc;
+  using value_type = std::string;
+  using reference  = std::string;
+  using category   = boost::read_write_property_map_tag;
+
+  Graph_t *g;
+};
+
+std::string get(const roleMap &m, const Graph::vDesc &v)
+{
+  return Role::toString((*m.g)[v].role);
+}
+
+void put(const roleMap &m, const Graph::vDesc &v, const std::string &r)
+{
+  (*m.g)[v].role = Role::parse(r);
+}
+
+
 Graph_t Graph::parse(const std::string &path)
 {
   Graph_t g;
@@ -14,10 +64,9 @@ Graph_t Graph::parse(const std::string &path)
   boost::dynamic_properties dp(boost::ignore_other_properties);
 
   dp.property("node_id", boost::get(&VerticeProps::name, g));
-  dp.property("role", boost::get(&VerticeProps::role, g));
+  dp.property("role", roleMap{&g});
 
-  dp.property("label", boost::get(&EdgeProps::label, g));
-  dp.property("lowlink", boost::get(&EdgeProps::lowlink, g));
+  dp.property("label", labelInternMap{&g});
 
   std::ifstream m(path);
 
@@ -29,40 +78,35 @@ Graph_t Graph::parse(const std::string &path)
 
   boost::read_graphviz(m, g, dp);
 
+  GraphProps &props = g[boost::graph_bundle];
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    if (Role::has(g[v].role, Role::start))
+      props.start = v;
+
+    if (Role::has(g[v].role, Role::end))
+      props.finals.set(v);
+  }
+
   return g;
 }
 
 bool Graph::isFinalState(const Graph_t &g, const Graph::vDesc &vd)
 {
-  return (g[vd].role == "end");
+  return g[boost::graph_bundle].finals.test(vd);
 }
 
 Graph::vDesc Graph::getStart(const Graph_t &g)
 {
-  Graph::vDesc start;
-  const Range<Graph::vIter> vertices = Util::makeRange(boost::vertices(g));
-
-  for (const Graph::vDesc &v : vertices) {
-    if (g[v].role == "start")
-      start = v;
-  }
-
-  return start;
+  return g[boost::graph_bundle].start;
 }
 
 
 std::vector<Graph::vDesc> Graph::getEnds(const Graph_t &g)
 {
-  std::vector<Graph::vDesc> res;
-
-  const Range<Graph::vIter> vertices = Util::makeRange(boost::vertices(g));
+  const Bitset &finals = g[boost::graph_bundle].finals;
 
-  for (const Graph::vDesc &v : vertices) {
-    if (g[v].role == "end")
-      res.push_back(v);
-  }
-
-  return res;
+  return std::vector<Graph::vDesc>(finals.begin(), finals.end());
 }
 
 
@@ -83,9 +127,12 @@ std::vector<Graph::eDesc> Graph::getOutEdgesVec(const Graph_t &g, const Graph::v
   return res;
 }
 
+/**
+ * the vertex named vName. it has to exist.
+ */
 Graph::vDesc Graph::getVertex(const std::string &vName, const Graph_t &g)
 {
-  Graph::vDesc res;
+  Graph::vDesc res = boost::graph_traits<Graph_t>::null_vertex();
   const Range<Graph::vIter> vertices = Util::makeRange(boost::vertices(g));
 
   for (const Graph::vDesc &v : vertices) {
@@ -93,12 +140,20 @@ Graph::vDesc Graph::getVertex(const std::string &vName, const Graph_t &g)
       res = v;
   }
 
+  if (res == boost::graph_traits<Graph_t>::null_vertex()) {
+    std::cout << "[Err] Graph::getVertex // no vertex named " << vName << std::endl;
+    exit(1);
+  }
+
   return res;
 }
 
-Graph::vDesc Graph::getDst(const Graph::vDesc &v, const std::string &l, const Graph_t &g)
+/**
+ * destination of the first out-edge of v with label l. v has to have one.
+ */
+Graph::vDesc Graph::getDst(const Graph::vDesc &v, const label &l, const Graph_t &g)
 {
-  Graph::vDesc dst;
+  Graph::vDesc dst = boost::graph_traits<Graph_t>::null_vertex();
 
   Range<Graph::oeIter> oes = Graph::getOutEdges(g, v);
 
@@ -109,85 +164,288 @@ Graph::vDesc Graph::getDst(const Graph::vDesc &v, const std::string &l, const Gr
     }
   }
 
+  if (dst == boost::graph_traits<Graph_t>::null_vertex()) {
+    std::cout << "[Err] Graph::getDst // vertex " << g[v].name << " has no edge labeled " << Lbl::name(l) << std::endl;
+    exit(1);
+  }
+
   return dst;
 }
 
 /**
- * @deprecated in favor of Graph::getDestinationsWithEpsilonClosure
+ * epsilon closure of every state of g: the states reachable over edges with
+ * the empty grouping, the state itself included.
+ *
+ * computed once for the whole graph on the condensation of the epsilon
+ * subgraph: the closure of a component is its members plus the closures of
+ * the components it has epsilon edges to, all members share it. so long tau
+ * chains and cycles are walked once instead of once per determinized state.
  */
-std::set<Graph::vDesc>
-Graph::getDestinations(const Graph_t &g, std::vector<Graph::eDesc> edges)
+std::vector<Bitset> Graph::getEpsilonClosures(const Graph_t &g)
 {
-  std::set<Graph::vDesc> res;
-  
-  for (const Graph::eDesc &e : edges)
-    res.insert(boost::target(e, g));
-  
-  return res;
+  const std::size_t n = boost::num_vertices(g);
+
+  std::vector<std::size_t> offsets(1, 0);
+  std::vector<std::size_t> targets;
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    for (const Graph::eDesc &e : Graph::getOutEdges(g, v)) {
+      if (g[e].gp == emptyGrouping)
+        targets.push_back(boost::target(e, g));
+    }
+
+    offsets.push_back(targets.size());
+  }
+
+  const Scc::Components comps = Scc::find(offsets, targets);
+
+  // successor components have smaller numbers, so they are done first.
+  std::vector<Bitset> componentClosures(comps.count);
+
+  for (std::size_t c = 0; c < comps.count; ++c) {
+    Bitset &closure = componentClosures[c];
+
+    for (std::size_t i = comps.memberOffsets[c]; i < comps.memberOffsets[c + 1]; ++i) {
+      const std::size_t v = comps.members[i];
+      closure.set(v);
+
+      for (std::size_t j = offsets[v]; j < offsets[v + 1]; ++j) {
+        if (comps.of[targets[j]] != c)
+          closure |= componentClosures[comps.of[targets[j]]];
+      }
+    }
+  }
+
+  std::vector<Bitset> closures(n);
+
+  for (std::size_t v = 0; v < n; ++v)
+    closures[v] = componentClosures[comps.of[v]];
+
+  return closures;
 }
 
-std::set<Graph::vDesc>
-Graph::getDestinationsWithEpsilonClosure(const Graph_t &g, std::vector<Graph::eDesc> edges)
+/**
+ * g with the unaligned behavior collapsed, for DG::determinize. edges with the
+ * empty grouping are internal moves, all other edges are visible by their
+ * label, since the dg keeps a label per edge.
+ *
+ * first the strongly connected components of the internal moves are merged,
+ * their states have the same epsilon closure. then states are merged if they
+ * are branching bisimilar, by refining signatures: the signature of a state
+ * is the set of its visible moves and internal moves to other blocks, plus
+ * the signatures of the states of its own block it has internal moves to.
+ * being final counts as a visible move. merging keeps the language of every
+ * epsilon closure.
+ *
+ * the start state is never merged, since the dg does not close it. merged
+ * states are named by their members and keep their edges without duplicates.
+ * if nothing can be merged, g is returned as it is.
+ */
+Graph_t Graph::reduce(const Graph_t &g)
 {
-  // set of vertices that are connected to as the target of the edges and via epsilon-closure
-  std::set<Graph::vDesc> outputVertexSet;
-  
-  // queue of vertices that may be have further outgoing epsilon edges
-  std::deque<Graph::vDesc> epsilonTodo;
-  
-  // hash map of vertices that we already visited. this map will be used to prevent processing
-  // a vertex more than once.
-  std::unordered_map<Graph::vDesc, bool> epsilonDone;
-  
-  for (const Graph::eDesc &e : edges)
-  {
-    auto target = boost::target(e, g);
-    
-    // add to vertex list
-    outputVertexSet.insert(target);
-    
-    // add to todo list so that we check for epsilon edges
-    epsilonTodo.push_back(target);
+  const std::size_t n = boost::num_vertices(g);
+  const Graph::vDesc start = Graph::getStart(g);
+
+  std::vector<std::size_t> offsets(1, 0);
+  std::vector<std::size_t> targets;
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    for (const Graph::eDesc &e : Graph::getOutEdges(g, v)) {
+      const Graph::vDesc dst = boost::target(e, g);
+
+      if (g[e].gp == emptyGrouping && v != start && dst != start)
+        targets.push_back(dst);
+    }
+
+    offsets.push_back(targets.size());
   }
-  
-  // now recursively check all vertices for epsilon-edges and add
-  // every vertex that is connected this way (calculate epsilon closure).
-  while (!epsilonTodo.empty())
-  {
-    // pop current item
-    auto vertex = epsilonTodo.front();
-    epsilonTodo.pop_front();
-    
-    // mark this vertex as done so that we don't push it into our todo queue once more
-    epsilonDone.insert({vertex, true});
-    
-    // for all outgoing edges
-    for (const auto &edgeDescriptor : Graph::getOutEdges(g, vertex))
-    {
-      auto edge = g[edgeDescriptor];
-      
-      // empty grouping on edge label means the label is considered an epsilon.
-      // the grouping property is the set of all groups this label is contained in.
-      // if the label is not contained in any group then this set of groups will be empty.
-      if ( edge.gp.empty() )
-      {
-        // this target vertex is connected via epsilon edge
-        auto target = boost::target(edgeDescriptor, g);
-        
-        // check first if we already did this vertex and only push it if not.
-        if (epsilonDone.find(target) == epsilonDone.end())
-        {
-          // add to vertex list
-          outputVertexSet.insert(target);
-        
-          // add to todo list so that we check for epsilon edges
-          epsilonTodo.push_back(target);
-        }
+
+  // components are numbered successors first, so a signature only depends on
+  // signatures computed before it in a round.
+  const Scc::Components comps = Scc::find(offsets, targets);
+
+  // moves of the components: (label, component), internal moves as tau.
+  const std::uint64_t tau  = UINT64_MAX;
+  const std::uint64_t tick = UINT64_MAX - 1;
+
+  using move = std::pair<std::uint64_t, std::size_t>;
+
+  std::vector<std::vector<move>> moves(comps.count);
+  std::vector<bool> final(comps.count, false);
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    const std::size_t c = comps.of[v];
+
+    if (Graph::isFinalState(g, v))
+      final[c] = true;
+
+    for (const Graph::eDesc &e : Graph::getOutEdges(g, v)) {
+      const std::size_t dst = comps.of[boost::target(e, g)];
+
+      if (g[e].gp != emptyGrouping)
+        moves[c].push_back(move(g[e].label, dst));
+      else if (dst != c)
+        moves[c].push_back(move(tau, dst));
+    }
+  }
+
+  std::vector<std::size_t> blocks(comps.count, 1);
+  blocks[comps.of[start]] = 0;
+
+  std::size_t count = (comps.count > 1) ? 2 : 1;
+
+  std::vector<std::vector<move>> sigs(comps.count);
+
+  while (true) {
+    for (std::size_t c = 0; c < comps.count; ++c) {
+      std::vector<move> &sig = sigs[c];
+      sig.clear();
+
+      if (final[c])
+        sig.push_back(move(tick, 0));
+
+      for (const move &m : moves[c]) {
+        if (m.first == tau && blocks[m.second] == blocks[c])
+          sig.insert(sig.end(), sigs[m.second].begin(), sigs[m.second].end());
+        else
+          sig.push_back(move(m.first, blocks[m.second]));
       }
+
+      std::sort(sig.begin(), sig.end());
+      sig.erase(std::unique(sig.begin(), sig.end()), sig.end());
     }
+
+    std::map<std::pair<std::size_t, std::vector<move>>, std::size_t> keys;
+    std::vector<std::size_t> next(comps.count);
+
+    for (std::size_t c = 0; c < comps.count; ++c)
+      next[c] = keys.insert(std::make_pair(std::make_pair(blocks[c], sigs[c]), keys.size())).first->second;
+
+    blocks.swap(next);
+
+    if (keys.size() == count)
+      break;
+
+    count = keys.size();
+  }
+
+  if (count == n)
+    return g;
+
+  // merged states in the order of their first member.
+  const std::size_t none = SIZE_MAX;
+  std::vector<std::size_t> ids(count, none);
+  std::vector<std::vector<Graph::vDesc>> members;
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    const std::size_t b = blocks[comps.of[v]];
+
+    if (ids[b] == none) {
+      ids[b] = members.size();
+      members.push_back(std::vector<Graph::vDesc>());
+    }
+
+    members[ids[b]].push_back(v);
   }
-  
-  return outputVertexSet;
+
+  Graph_t res;
+  GraphProps &props = res[boost::graph_bundle];
+  props.name = g[boost::graph_bundle].name;
+
+  for (const std::vector<Graph::vDesc> &vs : members) {
+    const Graph::vDesc nv = boost::add_vertex(res);
+    std::string sep = "";
+
+    for (const Graph::vDesc &v : vs) {
+      res[nv].name += sep + g[v].name;
+      sep = ", ";
+
+      if (Graph::isFinalState(g, v))
+        res[nv].role |= Role::end;
+    }
+
+    if (vs.front() == start) {
+      res[nv].role |= Role::start;
+      props.start = nv;
+    }
+
+    if (Role::has(res[nv].role, Role::end))
+      props.finals.set(nv);
+  }
+
+  std::set<std::pair<std::uint64_t, std::size_t>> added;
+
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    added.clear();
+
+    for (const Graph::vDesc &v : members[i]) {
+      for (const Graph::eDesc &e : Graph::getOutEdges(g, v)) {
+        const std::size_t dst = ids[blocks[comps.of[boost::target(e, g)]]];
+        const bool internal = g[e].gp == emptyGrouping;
+
+        if (internal && dst == i)
+          continue;
+
+        if (!added.insert(move(internal ? tau : g[e].label, dst)).second)
+          continue;
+
+        const Graph::eDesc ne = boost::add_edge(i, dst, res).first;
+        res[ne] = g[e];
+      }
+    }
+  }
+
+  return res;
+}
+
+/**
+ * g without the states that cannot reach a final state. no run through them
+ * is ever accepted, so the language of every state that is kept does not
+ * change, and neither does any epsilon closure restricted to the states that
+ * are kept. the start state is kept in any case. if every state can reach a
+ * final state, g is returned as it is.
+ */
+Graph_t Graph::trim(const Graph_t &g)
+{
+  const Graph::vDesc start = Graph::getStart(g);
+
+  std::vector<bool> keep = Util::getCoReachable(g, g[boost::graph_bundle].finals);
+  keep[start] = true;
+
+  if (std::find(keep.begin(), keep.end(), false) == keep.end())
+    return g;
+
+  const std::size_t none = SIZE_MAX;
+  std::vector<std::size_t> ids(keep.size(), none);
+
+  Graph_t res;
+  GraphProps &props = res[boost::graph_bundle];
+  props.name = g[boost::graph_bundle].name;
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    if (!keep[v])
+      continue;
+
+    ids[v] = boost::add_vertex(g[v], res);
+
+    if (v == start)
+      props.start = ids[v];
+
+    if (Graph::isFinalState(g, v))
+      props.finals.set(ids[v]);
+  }
+
+  for (const Graph::vDesc &v : Util::makeRange(boost::vertices(g))) {
+    if (!keep[v])
+      continue;
+
+    for (const Graph::eDesc &e : Graph::getOutEdges(g, v)) {
+      if (keep[boost::target(e, g)])
+        boost::add_edge(ids[v], ids[boost::target(e, g)], g[e], res);
+    }
+  }
+
+  return res;
 }
 
 
@@ -205,19 +463,19 @@ Graph::getDestinationsWithEpsilonClosure(const Graph_t &g, std::vector<Graph::eD
 
 
 
-void Graph::print(const Graph_t &g)
+void Graph::print(const Graph_t &g, const groupingTable &gt)
 {
   std::cout << "digraph {" << std::endl;
 
   Range<Graph::vIter> vertices = Util::makeRange(boost::vertices(g));
 
   for (const Graph::vDesc &v : vertices) {
-    if (g[v].role == "start") {
+    if (Role::has(g[v].role, Role::start)) {
       std::cout << "  \"" << g[v].name << "\" [role=\"start\"]" << std::endl;
       continue;
     }
 
-    if (g[v].role == "end") {
+    if (Role::has(g[v].role, Role::end)) {
       std::cout << "  \"" << g[v].name << "\" [role=\"end\"]" << std::endl;
       continue;
     }
@@ -226,7 +484,7 @@ void Graph::print(const Graph_t &g)
   Util::printLine();
 
   for (const Graph::vDesc &v : vertices)
-    Graph::printOutEdges(g, v);
+    Graph::printOutEdges(g, v, gt);
 
   std::cout << "}\n\n" << std::endl;
 
@@ -248,21 +506,21 @@ void Graph::printEdges(const Graph_t &g)
   const Range<Graph::eIter> edges = Util::makeRange(boost::edges(g));
 
   for (const Graph::eDesc &e : edges)
-    std::cout << g[e].label << std::endl;
+    std::cout << Lbl::name(g[e].label) << std::endl;
 
   return;
 }
 
-void Graph::printOutEdge(const Graph_t &g, const eDesc &e)
+void Graph::printOutEdge(const Graph_t &g, const eDesc &e, const groupingTable &gt)
 {
   const Graph::vDesc src = boost::source(e, g);
   const Graph::vDesc dst = boost::target(e, g);
 
   std::cout << "  \"" << g[src].name << "\" -> \"" << g[dst].name << "\"";
-  std::cout << " [label=\"" << g[e].label << " gp: " << Alm::groupingToStr(g[e].gp) << "\"]" << std::endl;
+  std::cout << " [label=\"" << Lbl::name(g[e].label) << " gp: " << Alm::groupingToStr(gt, g[e].gp) << "\"]" << std::endl;
 }
 
-void Graph::printOutEdges(const Graph_t &g, const Graph::vDesc &vd) {
+void Graph::printOutEdges(const Graph_t &g, const Graph::vDesc &vd, const groupingTable &gt) {
 
   const Range<Graph::oeIter> outEdges = Util::makeRange(boost::out_edges(vd, g));
 
@@ -270,7 +528,7 @@ void Graph::printOutEdges(const Graph_t &g, const Graph::vDesc &vd) {
     return;
 
   for (const Graph::eDesc &e : outEdges)
-    Graph::printOutEdge(g, e);
+    Graph::printOutEdge(g, e, gt);
 
   return;
 }
@@ -1,6 +1,6 @@
 #include "HelperMaps.hpp"
 
-labelGroupingMap Helper::LabelGroupingMap(const Graph_t &g, const alignmentHalf &alh)
+labelGroupingMap Helper::LabelGroupingMap(const Graph_t &g, const alignmentHalf &alh, groupingTable &gt)
 {
   labelGroupingMap lgm;
 
@@ -11,9 +11,14 @@ labelGroupingMap Helper::LabelGroupingMap(const Graph_t &g, const alignmentHalf
 
   for (const Graph::eDesc &e : edges) {
     l = g[e].label;
+
+    // labels repeat on many edges, look each one up once.
+    if (lgm.count(l))
+      continue;
+
     gp = Alm::getGrouping(l, alh);
 
-    lgm[l] = gp;
+    lgm[l] = Alm::internGrouping(gt, gp);
   }
 
   return lgm;
@@ -50,19 +55,19 @@ edgeLabelSet Helper::lgmFlatten(const labelGroupingMap &lgm)
 {
   edgeLabelSet els;
 
-  for (const std::pair<label, alignmentGrouping> &p : lgm)
+  for (const std::pair<const label, groupingId> &p : lgm)
     els.insert(p.second);
 
   return els;
 }
 
-std::vector<label> Helper::elsFlatten(const edgeLabelSet &els)
+std::vector<label> Helper::elsFlatten(const edgeLabelSet &els, const groupingTable &gt)
 {
   std::vector<label> labels;
 
-  for (const alignmentGrouping &gp : els)
-    for (const alignmentGroup &g : gp)
-      for (const label &l : g)
+  for (const groupingId &gp : els)
+    for (const alignmentGroup &g : Alm::lookupGrouping(gt, gp))
+      for (label l : g)
         labels.push_back(l);
 
   return labels;
@@ -74,10 +79,10 @@ labelPermissivenessMap Helper::emptyLpm(const alignment &alm)
 
   for (const alignmentPair &p : alm) {
 
-    for (const label &l : p.first)
+    for (label l : p.first)
       lpm[l] = 0;
 
-    for (const label &l : p.second)
+    for (label l : p.second)
       lpm[l] = 0;
 
   }
@@ -91,11 +96,11 @@ labelPermissivenessMap Helper::LabelPermissivenessMap(const alignment &alm)
 
   for (const alignmentPair &p : alm) {
 
-    for (const label &l : p.first)
-      lpm[l] += p.second.size();
+    for (label l : p.first)
+      lpm[l] += p.second.count();
 
-    for (const label &l : p.second)
-      lpm[l] += p.first.size();
+    for (label l : p.second)
+      lpm[l] += p.first.count();
 
   }
 
@@ -120,7 +125,7 @@ int Helper::maxComplexity(const alignment &alm)
   int maxComplexity = 0;
 
   for (const alignmentPair &p : alm) {
-    int complexity = p.first.size() * p.second.size();
+    int complexity = p.first.count() * p.second.count();
 
     if (complexity > maxComplexity)
       maxComplexity = complexity;
@@ -138,10 +143,8 @@ void Helper::labelsToGroupings(Graph_t &g, labelGroupingMap &lgm)
 {
   const Range<Graph::eIter> edges = Util::makeRange(boost::edges(g));
 
-  for (const Graph::eDesc &e : edges) {
-    alignmentGrouping gp = lgm[g[e].label];
-    g[e].gp = gp;
-  }
+  for (const Graph::eDesc &e : edges)
+    g[e].gp = lgm[g[e].label];
 
   return;
 }
@@ -151,11 +154,11 @@ void Helper::labelsToGroupings(Graph_t &g, labelGroupingMap &lgm)
 
 
 
-void Helper::printLgm(const labelGroupingMap &lgm)
+void Helper::printLgm(const labelGroupingMap &lgm, const groupingTable &gt)
 {
-  for (const std::pair<label, alignmentGrouping> &p : lgm) {
-    std::cout << p.first << " ->  ";
-    Alm::printGrouping(p.second);
+  for (const std::pair<const label, groupingId> &p : lgm) {
+    std::cout << Lbl::name(p.first) << " ->  ";
+    Alm::printGrouping(Alm::lookupGrouping(gt, p.second));
     Util::printLine();
   }
 
@@ -165,7 +168,7 @@ void Helper::printLgm(const labelGroupingMap &lgm)
 void Helper::printLsm(const labelAlmSubMap &lsm)
 {
   for (const std::pair<label, alignmentSub> &p : lsm) {
-    std::cout << p.first << " -> " << std::endl;
+    std::cout << Lbl::name(p.first) << " -> " << std::endl;
     Alm::print(p.second);
     Util::printLine();
   }
@@ -173,10 +176,10 @@ void Helper::printLsm(const labelAlmSubMap &lsm)
   return;
 }
 
-void Helper::printEls(const edgeLabelSet &els)
+void Helper::printEls(const edgeLabelSet &els, const groupingTable &gt)
 {
-  for (const alignmentGrouping &gp : els) {
-    Alm::printGrouping(gp);
+  for (const groupingId &gp : els) {
+    Alm::printGrouping(Alm::lookupGrouping(gt, gp));
     Util::printLine();
   }
 
@@ -186,7 +189,7 @@ void Helper::printEls(const edgeLabelSet &els)
 void Helper::printLpm(const labelPermissivenessMap &lpm)
 {
   for (const std::pair<label, int> &p : lpm) {
-    std::cout << p.first << " ->  " << p.second;
+    std::cout << Lbl::name(p.first) << " ->  " << p.second;
     Util::printLine();
   }
 
@@ -0,0 +1,103 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+#include "LabelUtils.hpp"
+
+
+namespace {
+  // chunk k holds the names of the ids 2^k-1 .. 2^(k+1)-2, so the chunks
+  // cover all ids and a chunk never moves once it is allocated.
+  const std::size_t chunkCount = 33;
+
+  /**
+   * names are only appended, under the mutex. Lbl::name reads them without
+   * it: an id is only handed out after its name is stored, and its chunk is
+   * published before that, so any thread that knows an id finds its name.
+   */
+  struct labelTable {
+    std::mutex mutex;
+    std::unordered_map<std::string, labelId> ids;
+
+    std::atomic<std::size_t> size;
+    std::array<std::atomic<std::string *>, chunkCount> chunks;
+
+    labelTable() : size(0)
+    {
+      for (std::atomic<std::string *> &c : chunks)
+        c.store(nullptr);
+    }
+
+    ~labelTable()
+    {
+      for (std::atomic<std::string *> &c : chunks)
+        delete[] c.load();
+    }
+  };
+
+  labelTable &table()
+  {
+    static labelTable t;
+    return t;
+  }
+
+  /**
+   * chunk k and position i of the name of id l.
+   */
+  void locate(const std::size_t &l, std::size_t &k, std::size_t &i)
+  {
+    const std::size_t x = l + 1;
+
+    k = 0;
+
+    while ((x >> (k + 1)) != 0)
+      ++k;
+
+    i = x - (std::size_t(1) << k);
+  }
+}
+
+labelId Lbl::intern(const std::string &name)
+{
+  labelTable &t = table();
+  std::lock_guard<std::mutex> lock(t.mutex);
+
+  std::unordered_map<std::string, labelId>::const_iterator it = t.ids.find(name);
+
+  if (it != t.ids.end())
+    return it->second;
+
+  labelId l = t.size.load(std::memory_order_relaxed);
+
+  std::size_t k, i;
+  locate(l, k, i);
+
+  std::string *chunk = t.chunks[k].load(std::memory_order_relaxed);
+
+  if (chunk == nullptr) {
+    chunk = new std::string[std::size_t(1) << k];
+    t.chunks[k].store(chunk, std::memory_order_release);
+  }
+
+  chunk[i] = name;
+  t.ids[name] = l;
+
+  t.size.store(l + 1, std::memory_order_release);
+
+  return l;
+}
+
+const std::string &Lbl::name(const labelId &l)
+{
+  std::size_t k, i;
+  locate(l, k, i);
+
+  return table().chunks[k].load(std::memory_order_acquire)[i];
+}
+
+std::size_t Lbl::count()
+{
+  return table().size.load(std::memory_order_acquire);
+}
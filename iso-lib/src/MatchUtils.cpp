@@ -1,5 +1,4 @@
 #include <sstream>
-#include <boost/algorithm/string/join.hpp>
 
 #include "MatchUtils.hpp"
 
@@ -10,16 +9,11 @@ bool Match::hasLabel(const match &m, const label &l)
 }
 
 /**
- * return true iff match ma is an element of match set ms.
+ * return true iff the i-th pair of the alignment is an element of match set ms.
  */
-bool Match::setHasMatch(const matchSet &ms, const match &ma)
+bool Match::setHasMatch(const matchSet &ms, const std::size_t &i)
 {
-  for (const match &m : ms) {
-    if (m == ma)
-      return true;
-  }
-
-  return false;
+  return ms.test(i);
 }
 
 /**
@@ -27,10 +21,12 @@ bool Match::setHasMatch(const matchSet &ms, const match &ma)
  * match (G'_1, G'_2) in M with both G'_1 != G_1 and G'_2 != G_2, where (G_1, G_2) is
  * the passed argument ma.
  */
-bool Match::hasMatchWithBothGroupsDifferentThan(const matchSet &matchSet, const match &match)
+bool Match::hasMatchWithBothGroupsDifferentThan(const alignment &alm, const matchSet &ms, const match &ma)
 {
-  for (auto &currentMatch : matchSet) {
-    if (match.first != currentMatch.first && match.second != currentMatch.second)
+  for (const std::size_t &i : ms) {
+    const match &currentMatch = alm[i];
+
+    if (ma.first != currentMatch.first && ma.second != currentMatch.second)
     {
       // found a match with both G'_1 != G_1 and G'_2 != G_2
       return true;
@@ -43,7 +39,7 @@ bool Match::hasMatchWithBothGroupsDifferentThan(const matchSet &matchSet, const
 
 bool Match::empty(const match &m)
 {
-  return (m.first).empty();
+  return (m.first).none();
 }
 
 std::string Match::toString(const match &m)
@@ -51,32 +47,26 @@ std::string Match::toString(const match &m)
   std::stringstream res;
 
   res << "(";
-  res << boost::algorithm::join(m.first, ",");
+  res << Alm::groupToStr(m.first);
   res << " <> ";
-  res << boost::algorithm::join(m.second, ",");
+  res << Alm::groupToStr(m.second);
   res << ")";
 
   return res.str();
 }
 
-std::string Match::setToString(const matchSet &ms)
+std::string Match::setToString(const alignment &alm, const matchSet &ms)
 {
   std::stringstream res;
-  matchSet::const_iterator it;
-
-  if (ms.empty()) {
-    res << "{}";
-    return res.str();
-  }
+  std::string sep = "";
 
   res << "{";
 
-  for (it = ms.begin(); it != ms.end() - 1; ++it) {
-    res << Match::toString(*it);
-    res << ",";
+  for (const std::size_t &i : ms) {
+    res << sep << Match::toString(alm[i]);
+    sep = ",";
   }
 
-  res << Match::toString(*it);
   res << "}";
 
   return res.str();
@@ -87,63 +77,44 @@ std::string Match::setToString(const matchSet &ms)
  * which assumes that both K_i != \emptyset.
  * We use the old match set ms, the alignment alm and the two labels
  * that were chosen to advance each FSM ( K_1 = G(l1) etc. ).
+ *
+ * The candidates, all alignment pairs where the symbols l1 and l2 are included
+ * on each side respectively, come from the index idx of alm.
  */
-matchSet Match::getMatchSet(const alignment &alm, const matchSet &ms,
-                                          const label &l1, const label &l2)
+matchSet Match::getMatchSet(const alignment &alm, const alignmentIndex &idx, const matchSet &ms,
+                            const label &l1, const label &l2)
 {
-  // create empty result match set
-  matchSet resultMatchSet;
+  matchSet resultMatchSet = Alm::pairsWithLhs(idx, l1) & Alm::pairsWithRhs(idx, l2);
 
 #if ISO_LIB_ENFORCE_MAXIMALITY
-  
-  if (ms.empty())
-  {
-    // M defined according to first case (of first rule).
-    // previous M was empty, therefore new M will be K_1 x K_2 \cap \alignment
-    for (const alignmentPair &p : alm)
-    {
-      // include all alignment pairs where the symbols l1 and l2 are included on each side respectively
-      if ((Alm::hasLabel(p.first, l1)) && (Alm::hasLabel(p.second, l2)))
-      {
-        resultMatchSet.push_back(p);
-      } // if
-    } // for
-  } // if ms.empty
-  
-  else
-  {
-    // M defined according to second case (of first rule).
-    // previous M was not empty and K_1 != \emptyset and K_2 != \emptyset
-    for (const alignmentPair &p : alm)
-    {
-      // include all alignment pairs where the symbols l1 and l2 are included on each side respectively
-      if ((Alm::hasLabel(p.first, l1)) && (Alm::hasLabel(p.second, l2))
-          // exclude alignment pairs that are present in the previous match set
-          && ! Match::setHasMatch(ms, p)
-          // exclude this alignment pair if there isn't another pair in the previous match set
-          // that has different groupings on both sides (G'_1 != G_1 and G'_2 != G_2).
-          && Match::hasMatchWithBothGroupsDifferentThan(ms, p)
-      )
-      {
-        resultMatchSet.push_back(p);
-      } // if
-    } // for
-  } // if ms.empty
-  
+
+  // M defined according to first case (of first rule).
+  // previous M was empty, therefore new M will be K_1 x K_2 \cap \alignment
+  if (ms.none())
+    return resultMatchSet;
+
+  // M defined according to second case (of first rule).
+  // previous M was not empty and K_1 != \emptyset and K_2 != \emptyset.
+  // exclude alignment pairs that are present in the previous match set
+  resultMatchSet -= ms;
+
+  // exclude an alignment pair if there isn't another pair in the previous match set
+  // that has different groupings on both sides (G'_1 != G_1 and G'_2 != G_2).
+  matchSet candidates = resultMatchSet;
+
+  for (const std::size_t &i : candidates) {
+    if (!Match::hasMatchWithBothGroupsDifferentThan(alm, ms, alm[i]))
+      resultMatchSet.reset(i);
+  }
+
 #else
-  
+
+  (void) alm;
+
   // original paper definition which does not enforce maximality.
   // it now also excludes pairs that where present in the previous match set, to fit the paper definition.
-  for (const alignmentPair &p : alm) {
-    // include all alignment pairs where the symbols l1 and l2 are included on each side respectively
-    if ((Alm::hasLabel(p.first, l1)) && (Alm::hasLabel(p.second, l2))
-        // exclude alignment pairs that are present in the previous match set
-        && ! Match::setHasMatch(ms, p) )
-    {
-      resultMatchSet.push_back(p);
-    } // if
-  } // for
-  
+  resultMatchSet -= ms;
+
 #endif
 
   return resultMatchSet;
@@ -152,19 +123,31 @@ matchSet Match::getMatchSet(const alignment &alm, const matchSet &ms,
 /**
  * Get a new match set according to the second rule of the witness graph construction,
  * which assumes one of the K_i = \emptyset.
- * We use the old match set ms, the alignment alm and the two labels
- * that were chosen to advance each FSM ( K_1 = G(l1) etc. ).
+ * We keep the pairs of the old match set ms that contain label l on either side.
  */
-matchSet Match::getMatchSet2(const matchSet &ms, const label &l)
+matchSet Match::getMatchSet2(const alignmentIndex &idx, const matchSet &ms, const label &l)
 {
-  matchSet res;
+  return ms & (Alm::pairsWithLhs(idx, l) | Alm::pairsWithRhs(idx, l));
+}
 
-  for (const match &m : ms) {
-    if (Match::hasLabel(m, l))
-      res.push_back(m);
-  }
+matchSetId Match::intern(matchSetTable &mst, const matchSet &ms)
+{
+  std::unordered_map<matchSet, matchSetId>::const_iterator it = mst.ids.find(ms);
+
+  if (it != mst.ids.end())
+    return it->second;
+
+  matchSetId id = mst.sets.size();
+
+  mst.sets.push_back(ms);
+  mst.ids[ms] = id;
 
-  return res;
+  return id;
+}
+
+const matchSet &Match::lookup(const matchSetTable &mst, const matchSetId &id)
+{
+  return mst.sets[id];
 }
 
 
@@ -195,11 +178,11 @@ void Match::print(const match &m)
   return;
 }
 
-void Match::printSet(const matchSet &ms)
+void Match::printSet(const alignment &alm, const matchSet &ms)
 {
-  for (const match &m : ms) {
+  for (const std::size_t &i : ms) {
     std::cout << "  ";
-    Match::print(m);
+    Match::print(alm[i]);
   }
 
   return;
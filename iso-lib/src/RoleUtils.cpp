@@ -0,0 +1,37 @@
+#include "RoleUtils.hpp"
+
+
+/**
+ * role flags of a dot "role" attribute. unknown values are treated as no role.
+ */
+vertexRole Role::parse(const std::string &s)
+{
+  if (s == "start")
+    return Role::start;
+
+  if (s == "end")
+    return Role::end;
+
+  if (s == "empty")
+    return Role::empty;
+
+  return Role::none;
+}
+
+/**
+ * dot "role" attribute of r. only one role can be written, start takes
+ * precedence over end.
+ */
+std::string Role::toString(const vertexRole &r)
+{
+  if (Role::has(r, Role::start))
+    return "start";
+
+  if (Role::has(r, Role::end))
+    return "end";
+
+  if (Role::has(r, Role::empty))
+    return "empty";
+
+  return "";
+}
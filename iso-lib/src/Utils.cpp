@@ -3,6 +3,33 @@
 
 #include "Logging.hpp"
 
+/**
+ * the vertices that can reach one of the vertices in targets, targets
+ * included. preds[v] are the predecessors of v.
+ */
+std::vector<bool> Util::getCoReachable(const std::vector<std::vector<std::size_t>> &preds, const Bitset &targets)
+{
+  std::vector<bool> res(preds.size(), false);
+  std::vector<std::size_t> todo(targets.begin(), targets.end());
+
+  for (const std::size_t &v : todo)
+    res[v] = true;
+
+  while (!todo.empty()) {
+    const std::size_t v = todo.back();
+    todo.pop_back();
+
+    for (const std::size_t &p : preds[v]) {
+      if (!res[p]) {
+        res[p] = true;
+        todo.push_back(p);
+      }
+    }
+  }
+
+  return res;
+}
+
 void Util::printLine()
 {
   std::cout << std::endl;
@@ -1,463 +1,756 @@
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "MatchUtils.hpp"
+#include "Scc.hpp"
 #include "WitnessUtils.hpp"
 
 #include "Logging.hpp"
 
 
 
-WG::vDesc createStart(WG_t &wg, const DG_t &g1, const DG_t &g2)
+WG::Builder::Builder(WG_t &wg, const DG_t &g1, const DG_t &g2, labelGroupingMap &lgm1,
+                     labelGroupingMap &lgm2, const alignment &alm)
+  : wg(wg), g1(g1), g2(g2), lgm1(lgm1), lgm2(lgm2)
 {
-  matchSet ms;
-  WG::vDesc wgInit;
+  wg[boost::graph_bundle].alm = alm;
+  wg[boost::graph_bundle].almIndex = Alm::buildIndex(alm);
 
-  DG::vDesc gs1 = DG::getStart(g1);
-  DG::vDesc gs2 = DG::getStart(g2);
+  WG::Vertex init = WG::createVertex(DG::getStart(g1), DG::getStart(g2), emptyMatchSet);
+  init.role = Role::start;
 
-  WG::Vertex init = WG::createVertex(g1[gs1].name, g2[gs2].name, ms);
-  init.role = "start";
+  add(init);
+}
+
+const WG_t &WG::Builder::graph() const
+{
+  return wg;
+}
 
-  wgInit = WG::addVertex(init, wg);
+/**
+ * the vertex is final iff both of its DG states are.
+ */
+WG::vDesc WG::Builder::add(WG::Vertex &v)
+{
+  if (DG::isFinalState(g1, v.v1) && DG::isFinalState(g2, v.v2))
+    v.role |= Role::end;
 
-  return wgInit;
+  return WG::addVertex(v, wg);
 }
 
-WG_t WG::create(const DG_t &g1, const DG_t &g2, labelGroupingMap &lgm1,
-                labelGroupingMap &lgm2, const alignment &alm)
+/**
+ * the vertex with the key of v, added if it does not exist yet. new vertices
+ * are appended to found.
+ */
+WG::vDesc WG::Builder::get(WG::Vertex &v, std::vector<WG::vDesc> &found)
 {
-  WG_t wg;
-  matchSet ms, msNew;
+  WG::vDesc wgv = WG::findVertex(v, wg);
 
-  label l1, l2;
+  if (wgv != HashIndex::npos) {
+    DEBUG << "    vertex already exists. adding edge, not todo" << std::endl << std::endl;
+    return wgv;
+  }
 
-  WG::vDesc wgv1, wgv2;
+  DEBUG << "    new vertex doesn't exist. add vertex, add edge, add todo" << std::endl << std::endl;
 
-  DG::vDesc gv1, gv2;
-  DG::vDesc dst1, dst2;
+  wgv = add(v);
+  found.push_back(wgv);
 
-  Range<DG::oeIter> oe1, oe2;
+  return wgv;
+}
 
-  WG::Vertex init, currentV;
-  std::deque<WG::vDesc> wgTodo;
+/**
+ * add an out-edge to the row of the vertex being expanded. different label
+ * pairs often map to the same groupings, an edge that is in the row already
+ * is not added again.
+ */
+void WG::Builder::addEdge(const groupingId &gp1, const groupingId &gp2, const WG::vDesc &dst)
+{
+  const std::array<std::size_t, 3> k{{gp1, gp2, dst}};
+  const std::size_t h = HashIndex::hash(k.begin(), k.end());
 
+  const std::size_t i = rowIndex.find(h, [&](const std::size_t &j) {
+    return row[j].first == dst && row[j].second.gp1 == gp1 && row[j].second.gp2 == gp2;
+  });
 
+  if (i != HashIndex::npos)
+    return;
 
-  wgv1 = createStart(wg, g1, g2);
+  wgEdgeProps ep;
+  ep.gp1 = gp1;
+  ep.gp2 = gp2;
 
-  wgTodo.push_back(wgv1);
+  rowIndex.insert(h, row.size());
+  row.push_back(std::make_pair(dst, ep));
+}
 
+/**
+ * add the out-edges of v, unless that was done before, and append the
+ * vertices they lead to that are new to found.
+ */
+void WG::Builder::expand(const WG::vDesc &v, std::vector<WG::vDesc> &found)
+{
+  if (v >= expanded.size())
+    expanded.resize(v + 1, false);
 
-  while (!wgTodo.empty()) {
+  if (expanded[v])
+    return;
 
-    wgv1 = wgTodo.front();
-    wgTodo.pop_front();
+  expanded[v] = true;
 
-    gv1 = DG::getVertexByName(g1, wg[wgv1].v1Name);
-    gv2 = DG::getVertexByName(g2, wg[wgv1].v2Name);
+  const alignment &alm = wg[boost::graph_bundle].alm;
+  const alignmentIndex &idx = wg[boost::graph_bundle].almIndex;
+  matchSetTable &mst = wg[boost::graph_bundle].mst;
 
-    oe1 = Util::makeRange(boost::out_edges(gv1, g1));
-    oe2 = Util::makeRange(boost::out_edges(gv2, g2));
+  const Csr<dgEdgeProps> &csr1 = g1[boost::graph_bundle].csr;
+  const Csr<dgEdgeProps> &csr2 = g2[boost::graph_bundle].csr;
 
-    ms = wg[wgv1].ms;
+  const DG::vDesc gv1 = wg[v].v1;
+  const DG::vDesc gv2 = wg[v].v2;
 
-    currentV = WG::createVertex(wg[wgv1].v1Name, wg[wgv1].v2Name, ms);
-    DEBUG << "working on: " << currentV.name << std::endl;
+  const DG::oeRange oe1 = csr1.outEdges(gv1);
+  const DG::oeRange oe2 = csr2.outEdges(gv2);
 
-    if ((g1[gv1].role == "end") && (g2[gv2].role == "end"))
-      wg[wgv1].role = "end";
+  row.clear();
+  rowIndex.clear();
 
+  // copied, interning new match sets may move the table entries.
+  const matchSet ms = Match::lookup(mst, wg[v].ms);
+  matchSet msNew;
 
-    DEBUG << "  checking rule 1:" << std::endl;
+  const WG::Vertex currentV = WG::createVertex(gv1, gv2, wg[v].ms);
+  DEBUG << "working on: " << WG::getVertexKey(currentV) << std::endl;
 
-    for (const DG::eDesc &e1 : oe1) {
 
-      l1 = g1[e1].label;
+  DEBUG << "  checking rule 1:" << std::endl;
 
-      for (const WG::eDesc &e2 : oe2) {
-        l2 = g2[e2].label;
+  for (const std::size_t &e1 : oe1) {
 
-        msNew = Match::getMatchSet(alm, ms, l1, l2);
+    const label l1 = csr1.data(e1).label;
 
-        if (msNew.empty())
-          continue;
+    for (const std::size_t &e2 : oe2) {
+      const label l2 = csr2.data(e2).label;
 
-        DEBUG << "    found new match set" << std::endl;
-        DEBUG << "    " << l1 << ", " << l2 << ", " << Match::setToString(msNew) << std::endl;
+      msNew = Match::getMatchSet(alm, idx, ms, l1, l2);
 
-        dst1 = boost::target(e1, g1);
-        dst2 = boost::target(e2, g2);
+      if (msNew.none())
+        continue;
 
-        WG::Vertex newV = WG::createVertex(g1[dst1].name, g2[dst2].name, msNew);
-        DEBUG << "    new Vertex: " << newV.name << std::endl;
+      DEBUG << "    found new match set" << std::endl;
+      DEBUG << "    " << Lbl::name(l1) << ", " << Lbl::name(l2) << ", " << Match::setToString(alm, msNew) << std::endl;
 
-        if (WG::hasVertex(newV, wg)) {
-          DEBUG << "    vertex already exists. adding edge, not todo" << std::endl << std::endl;
-          wgv2 = WG::getVertex(newV, wg);
-          WG::addEdge(wgv1, lgm1[l1], lgm2[l2], wgv2, wg);
-          continue;
-        }
+      WG::Vertex newV = WG::createVertex(csr1.target(e1), csr2.target(e2), Match::intern(mst, msNew));
+      DEBUG << "    new Vertex: " << WG::getVertexKey(newV) << std::endl;
 
-        DEBUG << "    new vertex doesn't exist. add vertex, add edge, add todo" << std::endl << std::endl;
+      addEdge(lgm1[l1], lgm2[l2], get(newV, found));
+    }
+  }
 
-        wgv2 = WG::addVertex(newV, wg);
-        WG::addEdge(wgv1, lgm1[l1], lgm2[l2], wgv2, wg);
 
-        wgTodo.push_back(wgv2);
-      }
+
+
+  DEBUG << "  checking rule 2:" << std::endl;
+  DEBUG << "    g1 moves:" << std::endl;
+
+
+  for (const std::size_t &e1 : oe1) {
+    const label l1 = csr1.data(e1).label;
+
+    msNew = Match::getMatchSet2(idx, ms, l1);
+
+    if (msNew.none())
+      continue;
+
+    DEBUG << "    found new match set" << std::endl;
+    DEBUG << "    " << Lbl::name(l1) << ", " << Match::setToString(alm, msNew) << std::endl;
+
+    WG::Vertex newV = WG::createVertex(csr1.target(e1), gv2, Match::intern(mst, msNew));
+    DEBUG << "    new Vertex: " << WG::getVertexKey(newV) << std::endl << std::endl;
+
+    if (WG::vertexEqual(currentV, newV)) {
+      DEBUG << "   i,m the new vertex, only adding edge to myself " << std::endl;
+      addEdge(lgm1[l1], emptyGrouping, v);
+      continue;
     }
 
+    addEdge(lgm1[l1], emptyGrouping, get(newV, found));
+  }
 
 
 
-    DEBUG << "  checking rule 2:" << std::endl;
-    DEBUG << "    g1 moves:" << std::endl;
 
+  DEBUG << "  checking rule 2:" << std::endl;
+  DEBUG << "    g2 moves:" << std::endl;
 
-    for (const WG::eDesc &e1 : oe1) {
-          l1 = g1[e1].label;
 
-          msNew = Match::getMatchSet2(ms, l1);
+  for (const std::size_t &e2 : oe2) {
+    const label l2 = csr2.data(e2).label;
 
-          if (msNew.empty())
-            continue;
+    msNew = Match::getMatchSet2(idx, ms, l2);
 
-      DEBUG << "    found new match set" << std::endl;
-      DEBUG << "    " << l1 << ", " << Match::setToString(msNew) << std::endl;
+    if (msNew.none())
+      continue;
 
-      dst1 = boost::target(e1, g1);
-      dst2 = gv2;
+    DEBUG << "    found new match set" << std::endl;
+    DEBUG << "    " << Lbl::name(l2) << ", " << Match::setToString(alm, msNew) << std::endl;
 
-      alignmentGrouping gp2;
+    WG::Vertex newV = WG::createVertex(gv1, csr2.target(e2), Match::intern(mst, msNew));
+    DEBUG << "    new Vertex: " << WG::getVertexKey(newV) << std::endl << std::endl;
 
-      WG::Vertex newV = WG::createVertex(g1[dst1].name, g2[dst2].name, msNew);
-      DEBUG << "    new Vertex: " << newV.name << std::endl << std::endl;
+    if (WG::vertexEqual(currentV, newV)) {
+      DEBUG << "   i,m the new vertex, only adding edge to myself " << std::endl;
+      addEdge(emptyGrouping, lgm2[l2], v);
+      continue;
+    }
 
-      if (WG::vertexEqual(currentV, newV)) {
-        DEBUG << "   i,m the new vertex, only adding edge to myself " << std::endl;
-        wgv2 = wgv1;
-        WG::addEdge(wgv1, lgm1[l1], gp2, wgv2, wg);
-        continue;
-      }
+    addEdge(emptyGrouping, lgm2[l2], get(newV, found));
+  }
 
-      if (WG::hasVertex(newV, wg)) {
-        DEBUG << "   new vertex already exists. adding edge, not todo " << std::endl;
-        wgv2 = WG::getVertex(newV, wg);
-        WG::addEdge(wgv1, lgm1[l1], gp2, wgv2, wg);
-        continue;
-      }
+  wg[boost::graph_bundle].csr.addRow(v, row);
 
-      DEBUG << "   new vertex doesn't exist. add node, add edge, add todo! " << std::endl;
+  IF_DEBUG(
+    Util::printLineDebug();
+    WG::printOutEdgesDebug(wg, v);
+    Util::printLineDebug();
+  )
+}
 
-      wgv2 = WG::addVertex(newV, wg);
-      WG::addEdge(wgv1, lgm1[l1], gp2, wgv2, wg);
-      wgTodo.push_back(wgv2);
+/**
+ * the whole witness graph, expanded breadth-first from the start vertex, so
+ * the vertices are numbered and their rows stored in breadth-first order.
+ */
+WG_t WG::create(const DG_t &g1, const DG_t &g2, labelGroupingMap &lgm1,
+                labelGroupingMap &lgm2, const alignment &alm)
+{
+  WG_t wg;
+
+  WG::Builder b(wg, g1, g2, lgm1, lgm2, alm);
+
+  std::deque<WG::vDesc> wgTodo;
+  std::vector<WG::vDesc> found;
+
+  wgTodo.push_back(WG::getStart(wg));
+
+  while (!wgTodo.empty()) {
+    const WG::vDesc v = wgTodo.front();
+    wgTodo.pop_front();
+
+    found.clear();
+    b.expand(v, found);
+
+    wgTodo.insert(wgTodo.end(), found.begin(), found.end());
+
+    IF_DEBUG(
+      DEBUG << "Todo:" << std::endl;
+
+      for (const WG::vDesc &v : wgTodo)
+        DEBUG << "  " << v << std::endl;
+
+      Util::printLineDebug();
+      Util::printLineDebug();
+    )
+  }
+
+  return wg;
+}
+
+/**
+ * wg without the vertices that cannot reach a final vertex, for the dwg
+ * builders. a dwg state is final iff it contains a final vertex, and the
+ * vertices of an accepting dwg run all lie on a path to one, so removing the
+ * others keeps the language of the dwg. the start vertex is kept in any
+ * case. if every vertex can reach a final one, wg is returned as it is.
+ */
+WG_t WG::trim(const WG_t &wg)
+{
+  const WG::vDesc start = WG::getStart(wg);
+
+  std::vector<bool> keep = Util::getCoReachable(wg[boost::graph_bundle].csr, wg[boost::graph_bundle].finals);
+  keep[start] = true;
+
+  if (std::find(keep.begin(), keep.end(), false) == keep.end())
+    return wg;
+
+  const std::size_t none = SIZE_MAX;
+  std::vector<WG::vDesc> ids(keep.size(), none);
+
+  WG_t res;
+  wgProps &props = res[boost::graph_bundle];
+
+  props.name = wg[boost::graph_bundle].name;
+  props.alm = wg[boost::graph_bundle].alm;
+  props.almIndex = wg[boost::graph_bundle].almIndex;
+  props.mst = wg[boost::graph_bundle].mst;
+
+  for (const WG::vDesc &v : Util::makeRange(boost::vertices(wg))) {
+    if (!keep[v])
+      continue;
+
+    WG::Vertex nv = WG::createVertex(wg[v].v1, wg[v].v2, wg[v].ms);
+    nv.role = wg[v].role;
+
+    ids[v] = WG::addVertex(nv, res);
+  }
+
+  for (const WG::vDesc &v : Util::makeRange(boost::vertices(wg))) {
+    if (!keep[v])
+      continue;
+
+    for (const WG::eIndex &e : WG::getOutEdges(wg, v)) {
+      WG::vDesc dst = WG::getTarget(wg, e);
+
+      if (keep[dst])
+        WG::addEdge(ids[v], WG::getEdge(wg, e).gp1, WG::getEdge(wg, e).gp2, ids[dst], res);
     }
+  }
+
+  WG::freeze(res);
 
+  return res;
+}
+
+/**
+ * build the frozen out-edges of wg. the edges are dropped from the adjacency
+ * lists, wg must not get new edges afterwards.
+ */
+void WG::freeze(WG_t &wg)
+{
+  wg[boost::graph_bundle].csr = Csr<wgEdgeProps>::freeze(wg, [&](const WG::eDesc &e) {
+    return wg[e];
+  });
 
+  Util::dropEdges(wg);
+}
 
+/**
+ * condensation of the empty moves of Side. each component is stored once,
+ * with the components it has empty edges to.
+ */
+template <typename Side>
+WG::Closures WG::getEmptyClosures(const WG_t &wg)
+{
+  const Csr<wgEdgeProps> &csr = wg[boost::graph_bundle].csr;
+  const std::size_t n = csr.numVertices();
 
-    DEBUG << "  checking rule 2:" << std::endl;
-    DEBUG << "    g2 moves:" << std::endl;
+  std::vector<std::size_t> offsets(1, 0);
+  std::vector<std::size_t> targets;
 
+  for (std::size_t v = 0; v < n; ++v) {
+    for (const std::size_t &e : csr.outEdges(v)) {
+      if (Side::grouping(csr.data(e)) == emptyGrouping)
+        targets.push_back(csr.target(e));
+    }
 
-    for (const WG::eDesc &e2 : oe2) {
-          l2 = g2[e2].label;
+    offsets.push_back(targets.size());
+  }
 
-          msNew = Match::getMatchSet2(ms, l2);
+  Scc::Components comps = Scc::find(offsets, targets);
 
-          if (msNew.empty())
-            continue;
+  WG::Closures cl;
+  cl.component = std::move(comps.of);
+  cl.memberOffsets = std::move(comps.memberOffsets);
+  cl.members = std::move(comps.members);
+  cl.succOffsets.push_back(0);
+  cl.visited.assign(comps.count, false);
 
-      DEBUG << "    found new match set" << std::endl;
-      DEBUG << "    " << l2 << ", " << Match::setToString(msNew) << std::endl;
+  // the component the last successor d was added for, so each is added once.
+  std::vector<std::size_t> added(comps.count, SIZE_MAX);
 
-      dst1 = gv1;
-      dst2 = boost::target(e2, g2);
+  for (std::size_t c = 0; c < comps.count; ++c) {
+    for (std::size_t i = cl.memberOffsets[c]; i < cl.memberOffsets[c + 1]; ++i) {
+      const std::size_t v = cl.members[i];
 
-      alignmentGrouping gp1;
+      for (std::size_t j = offsets[v]; j < offsets[v + 1]; ++j) {
+        const std::size_t d = cl.component[targets[j]];
 
-      WG::Vertex newV = WG::createVertex(g1[dst1].name, g2[dst2].name, msNew);
-      DEBUG << "    new Vertex: " << newV.name << std::endl << std::endl;
+        if (d == c || added[d] == c)
+          continue;
 
-      if (WG::vertexEqual(currentV, newV)) {
-        DEBUG << "   i,m the new vertex, only adding edge to myself " << std::endl;
-        wgv2 = wgv1;
-        WG::addEdge(wgv1, gp1, lgm2[l2], wgv2, wg);
-        continue;
+        added[d] = c;
+        cl.succs.push_back(d);
       }
+    }
 
-      if (WG::hasVertex(newV, wg)) {
-        DEBUG << "   new vertex already exists. adding edge, not todo " << std::endl;
-        wgv2 = WG::getVertex(newV, wg);
-        WG::addEdge(wgv1, gp1, lgm2[l2], wgv2, wg);
-        continue;
-      }
+    cl.succOffsets.push_back(cl.succs.size());
+  }
 
-      DEBUG << "   new vertex doesn't exist. add node, add edge, add todo! " << std::endl;
+  return cl;
+}
 
-      wgv2 = WG::addVertex(newV, wg);
-      WG::addEdge(wgv1, gp1, lgm2[l2], wgv2, wg);
-      wgTodo.push_back(wgv2);
-    }
+template WG::Closures WG::getEmptyClosures<WG::Lhs>(const WG_t &wg);
+template WG::Closures WG::getEmptyClosures<WG::Rhs>(const WG_t &wg);
 
+/**
+ * closure of the set vs: the members of all components reachable from the
+ * components of vs, found by a depth-first search over the condensation.
+ */
+std::vector<WG::vDesc> WG::getClosure(WG::Closures &cl, const std::vector<WG::vDesc> &vs)
+{
+  std::vector<std::size_t> reached;
+  std::vector<std::size_t> stack;
 
-    Util::printLineDebug();
-    WG::printDebug(wg);
-    Util::printLineDebug();
+  for (const WG::vDesc &v : vs) {
+    const std::size_t c = cl.component[v];
 
+    if (cl.visited[c])
+      continue;
 
-    DEBUG << "Todo:" << std::endl;
+    cl.visited[c] = true;
+    stack.push_back(c);
+  }
 
-    for (const WG::vDesc &v : wgTodo)
-      DEBUG << "  " << wg[v].name << std::endl;
+  while (!stack.empty()) {
+    const std::size_t c = stack.back();
+    stack.pop_back();
 
-    Util::printLineDebug();
-    Util::printLineDebug();
-    Util::printLineDebug();
+    reached.push_back(c);
+
+    for (std::size_t i = cl.succOffsets[c]; i < cl.succOffsets[c + 1]; ++i) {
+      const std::size_t d = cl.succs[i];
+
+      if (cl.visited[d])
+        continue;
+
+      cl.visited[d] = true;
+      stack.push_back(d);
+    }
   }
 
+  std::vector<WG::vDesc> res;
 
+  for (const std::size_t &c : reached) {
+    res.insert(res.end(), cl.members.begin() + cl.memberOffsets[c], cl.members.begin() + cl.memberOffsets[c + 1]);
+    cl.visited[c] = false;
+  }
+
+  // the members of a single component are sorted already.
+  if (reached.size() > 1)
+    std::sort(res.begin(), res.end());
+
+  return res;
+}
+
+template <typename Side>
+WG::Frozen<Side>::Frozen(const WG_t &wg) : wg(wg), closures(WG::getEmptyClosures<Side>(wg))
+{
+}
+
+template <typename Side>
+const WG_t &WG::Frozen<Side>::graph() const
+{
   return wg;
 }
 
-WG::Vertex WG::createVertex(const vName &v1, const vName &v2, const matchSet &ms)
+template <typename Side>
+std::vector<WG::vDesc> WG::Frozen<Side>::closure(const std::vector<WG::vDesc> &vs)
 {
-  WG::Vertex v;
+  return WG::getClosure(closures, vs);
+}
 
-  v.v1Name = v1;
-  v.v2Name = v2;
-  v.ms     = ms;
+template class WG::Frozen<WG::Lhs>;
+template class WG::Frozen<WG::Rhs>;
 
-  v.name = WG::getVertexName(v);
+template <typename Side>
+WG::OnDemand<Side>::OnDemand(WG::Builder &b) : b(b)
+{
+}
 
-  return v;
+template <typename Side>
+const WG_t &WG::OnDemand<Side>::graph() const
+{
+  return b.graph();
 }
 
-WG::vDesc WG::getVertex(const WG::Vertex &v, const WG_t &wg)
+template <typename Side>
+void WG::OnDemand<Side>::expand(const WG::vDesc &v)
 {
-  WG::vDesc nv;
+  found.clear();
+  b.expand(v, found);
+}
 
-  Range<WG::vIter> vertices = Util::makeRange(boost::vertices(wg));
+/**
+ * closure of vs by a depth-first search over the empty moves of Side. every
+ * vertex it reaches is expanded, so its out-edges are known afterwards.
+ */
+template <typename Side>
+std::vector<WG::vDesc> WG::OnDemand<Side>::closure(const std::vector<WG::vDesc> &vs)
+{
+  std::vector<WG::vDesc> res;
+  std::vector<WG::vDesc> stack;
 
-  for (const WG::vDesc &wgv : vertices) {
-    if (wg[wgv].name == v.name)
-      nv = wgv;
+  for (const WG::vDesc &v : vs) {
+    if (v >= marked.size())
+      marked.resize(v + 1, false);
+
+    if (marked[v])
+      continue;
+
+    marked[v] = true;
+    stack.push_back(v);
   }
 
-  return nv;
+  while (!stack.empty()) {
+    const WG::vDesc v = stack.back();
+    stack.pop_back();
+
+    res.push_back(v);
+    expand(v);
+
+    for (const WG::eIndex &e : WG::getOutEdges(graph(), v)) {
+      if (Side::grouping(WG::getEdge(graph(), e)) != emptyGrouping)
+        continue;
+
+      const WG::vDesc dst = WG::getTarget(graph(), e);
+
+      if (dst >= marked.size())
+        marked.resize(dst + 1, false);
+
+      if (marked[dst])
+        continue;
+
+      marked[dst] = true;
+      stack.push_back(dst);
+    }
+  }
+
+  for (const WG::vDesc &v : res)
+    marked[v] = false;
+
+  std::sort(res.begin(), res.end());
+
+  return res;
+}
+
+template class WG::OnDemand<WG::Lhs>;
+template class WG::OnDemand<WG::Rhs>;
+
+WG::Vertex WG::createVertex(const DG::vDesc &v1, const DG::vDesc &v2, const matchSetId &ms)
+{
+  WG::Vertex v;
+
+  v.v1 = v1;
+  v.v2 = v2;
+  v.ms = ms;
+
+  return v;
+}
+
+WG::vDesc WG::getVertex(const WG::Vertex &v, const WG_t &wg)
+{
+  return WG::findVertex(v, wg);
+}
+
+/**
+ * descriptor of the vertex with the same (v1, v2, ms) as v, or HashIndex::npos.
+ */
+WG::vDesc WG::findVertex(const WG::Vertex &v, const WG_t &wg)
+{
+  return wg[boost::graph_bundle].index.find(WG::hashVertex(v), [&](const std::size_t &wgv) {
+    return wg[wgv].v1 == v.v1 && wg[wgv].v2 == v.v2 && wg[wgv].ms == v.ms;
+  });
 }
 
 WG::vDesc WG::addVertex(const WG::Vertex &v, WG_t &wg)
 {
   WG::vDesc nv = boost::add_vertex(wg);
 
-  wg[nv].name   = v.name;
-  wg[nv].v1Name = v.v1Name;
-  wg[nv].v2Name = v.v2Name;
-  wg[nv].ms     = v.ms;
-  wg[nv].role   = v.role;
+  wg[nv].v1   = v.v1;
+  wg[nv].v2   = v.v2;
+  wg[nv].ms   = v.ms;
+  wg[nv].role = v.role;
+
+  wg[boost::graph_bundle].index.insert(WG::hashVertex(v), nv);
+
+  if (Role::has(v.role, Role::start))
+    wg[boost::graph_bundle].start = nv;
+
+  if (Role::has(v.role, Role::end))
+    wg[boost::graph_bundle].finals.set(nv);
 
   return nv;
 }
 
-WG::eDesc WG::addEdge(WG::vDesc &v1, const alignmentGrouping &gp1,
-                    const alignmentGrouping &gp2, WG::vDesc &v2, WG_t &wg)
+WG::eDesc WG::addEdge(WG::vDesc &v1, const groupingId &gp1,
+                    const groupingId &gp2, WG::vDesc &v2, WG_t &wg)
 {
   WG::eDesc e = boost::add_edge(v1, v2, wg).first;
 
-  std::stringstream name;
-  name << Alm::groupingToStr(gp1) << " | " << Alm::groupingToStr(gp2);
-
-  wg[e].name = name.str();
   wg[e].gp1  = gp1;
   wg[e].gp2  = gp2;
 
   return e;
 }
 
-std::string WG::getVertexName(const WG::Vertex &v)
+/**
+ * name of v for output. rendered on demand from the names of the two DG states
+ * and the match set.
+ */
+std::string WG::getVertexName(const WG_t &wg, const WG::vDesc &v, const DG_t &g1, const DG_t &g2)
 {
+  const wgProps &props = wg[boost::graph_bundle];
   std::stringstream name;
 
-  name << "" << v.v1Name << ", " << v.v2Name << ", ";
-  name << Match::setToString(v.ms) << "";
+  name << "" << DG::getVertexName(g1, wg[v].v1) << ", " << DG::getVertexName(g2, wg[v].v2) << ", ";
+  name << Match::setToString(props.alm, Match::lookup(props.mst, wg[v].ms)) << "";
 
   return name.str();
 }
 
-WG::vDesc WG::getStart(const WG_t &wg)
+/**
+ * short form of the key of v, for debug output.
+ */
+std::string WG::getVertexKey(const WG::Vertex &v)
 {
-  WG::vDesc start;
-  const Range<WG::vIter> vertices = Util::makeRange(boost::vertices(wg));
+  std::stringstream key;
 
-  for (const WG::vDesc &v : vertices) {
-    if (wg[v].role == "start")
-      start = v;
-  }
+  key << "(" << v.v1 << ", " << v.v2 << ", #" << v.ms << ")";
 
-  return start;
+  return key.str();
 }
 
-bool WG::hasVertex(const WG::Vertex &v, const WG_t &wg)
+std::size_t WG::hashVertex(const WG::Vertex &v)
 {
-  Range<WG::vIter> vertices = Util::makeRange(boost::vertices(wg));
-
-  for (const WG::vDesc &wgv : vertices) {
-    if (wg[wgv].name == v.name)
-      return true;
-  }
-
-  return false;
+  return HashIndex::combine(HashIndex::combine(v.v1, v.v2), v.ms);
 }
 
-bool WG::vertexEqual(const WG::Vertex &v1, const WG::Vertex &v2)
+WG::vDesc WG::getStart(const WG_t &wg)
 {
-  if (v1.name == v2.name)
-    return true;
-
-  return false;
+  return wg[boost::graph_bundle].start;
 }
 
-bool WG::hasEdgeLhs(const std::vector<WG::eDesc> &oes, const alignmentGrouping &gp, const WG_t &wg)
+bool WG::isFinalState(const WG_t &wg, const WG::vDesc &wgv)
 {
-  for (const WG::eDesc &e : oes) {
-    if (Alm::groupingEqual(wg[e].gp1, gp))
-      return true;
-  }
-
-  return false;
+  return wg[boost::graph_bundle].finals.test(wgv);
 }
 
-bool WG::hasEdgeRhs(const std::vector<WG::eDesc> &oes, const alignmentGrouping &gp, const WG_t &wg)
+void WG::setFinalState(WG_t &wg, const WG::vDesc &wgv)
 {
-  for (const WG::eDesc &e : oes) {
-    if (Alm::groupingEqual(wg[e].gp2, gp))
-      return true;
-  }
-
-  return false;
+  wg[wgv].role |= Role::end;
+  wg[boost::graph_bundle].finals.set(wgv);
 }
 
-bool WG::hasEmptyTransitionLhs(const std::vector<WG::eDesc> &oes, const WG_t &wg)
+bool WG::hasVertex(const WG::Vertex &v, const WG_t &wg)
 {
-  for (const WG::eDesc &e : oes) {
-    if (wg[e].gp1.empty())
-      return true;
-  }
-
-  return false;
+  return WG::findVertex(v, wg) != HashIndex::npos;
 }
 
-bool WG::hasEmptyTransitionRhs(const std::vector<WG::eDesc> &oes, const WG_t &wg)
+bool WG::vertexEqual(const WG::Vertex &v1, const WG::Vertex &v2)
 {
-  for (const WG::eDesc &e : oes) {
-    if (wg[e].gp2.empty())
-      return true;
-  }
-
-  return false;
+  return v1.v1 == v2.v1 && v1.v2 == v2.v2 && v1.ms == v2.ms;
 }
 
-bool WG::hasEmptyTransitionLhs(const Range<WG::oeIter> &oes, const WG_t &wg)
+/**
+ * out-edges of v as indices into the frozen graph.
+ */
+WG::oeRange WG::getOutEdges(const WG_t &wg, const WG::vDesc &v)
 {
-  for (const WG::eDesc &e : oes) {
-    if (wg[e].gp1.empty())
-      return true;
-  }
-
-  return false;
+  return wg[boost::graph_bundle].csr.outEdges(v);
 }
 
-bool WG::hasEmptyTransitionRhs(const Range<WG::oeIter> &oes, const WG_t &wg)
+const wgEdgeProps &WG::getEdge(const WG_t &wg, const WG::eIndex &e)
 {
-  for (const WG::eDesc &e : oes) {
-    if (wg[e].gp2.empty())
-      return true;
-  }
-
-  return false;
+  return wg[boost::graph_bundle].csr.data(e);
 }
 
-std::vector<WG::eDesc> WG::getEdgesWithLabelLhs(const std::vector<WG::eDesc> &oes,
-                                                const alignmentGrouping &gp,
-                                                const WG_t &wg)
+WG::vDesc WG::getTarget(const WG_t &wg, const WG::eIndex &e)
 {
-  std::vector<WG::eDesc> edges;
-
-  for (const WG::eDesc &e : oes) {
-    if (Alm::groupingEqual(wg[e].gp1, gp))
-      edges.push_back(e);
-  }
-
-  return edges;
+  return wg[boost::graph_bundle].csr.target(e);
 }
 
-std::vector<WG::eDesc> WG::getEdgesWithLabelRhs(const std::vector<WG::eDesc> &oes,
-                                                const alignmentGrouping &gp,
-                                                const WG_t &wg)
-{
-  std::vector<WG::eDesc> edges;
+const std::size_t WG::Buckets::npos;
 
-  for (const WG::eDesc &e : oes) {
-    if (Alm::groupingEqual(wg[e].gp2, gp))
-      edges.push_back(e);
+/**
+ * counting sort of oes by their grouping on Side into b, reusing its storage.
+ * edges with a grouping of width or above are dropped.
+ */
+template <typename Side>
+void WG::bucket(const std::vector<WG::eIndex> &oes, const std::size_t &width, const WG_t &wg, WG::Buckets &b)
+{
+  if (b.slot.size() < width) {
+    b.slot.resize(width, WG::Buckets::npos);
+    b.count.resize(width, 0);
   }
 
-  return edges;
-}
+  // only the buckets of the last call are set.
+  for (const groupingId &gp : b.groupings)
+    b.slot[gp] = WG::Buckets::npos;
 
+  b.groupings.clear();
 
-std::vector<WG::vDesc> WG::getDestinations(const std::vector<WG::eDesc> &es, const WG_t &wg)
-{
-  std::vector<WG::vDesc> dsts;
+  for (const WG::eIndex &e : oes) {
+    const groupingId gp = Side::grouping(WG::getEdge(wg, e));
 
-  for (const WG::eDesc &e : es)
-    dsts.push_back(boost::target(e, wg));
+    if (gp < width && b.count[gp]++ == 0)
+      b.groupings.push_back(gp);
+  }
 
-  return dsts;
-}
+  std::sort(b.groupings.begin(), b.groupings.end());
 
-std::vector<WG::eDesc> WG::getEmptyEdgesLhs(const Range<WG::oeIter> &oes, const WG_t &wg)
-{
-  std::vector<WG::eDesc> eedges;
+  b.offsets.assign(1, 0);
+
+  for (std::size_t i = 0; i < b.groupings.size(); ++i) {
+    const groupingId gp = b.groupings[i];
 
-  for (const WG::eDesc &e : oes) {
-    if (wg[e].gp1.empty())
-      eedges.push_back(e);
+    b.slot[gp] = i;
+    b.offsets.push_back(b.offsets[i] + b.count[gp]);
+
+    // the count is the next free position of the bucket from here on.
+    b.count[gp] = b.offsets[i];
   }
 
-  return eedges;
-}
+  b.edges.resize(b.offsets.back());
 
-std::vector<WG::eDesc> WG::getEmptyEdgesRhs(const Range<WG::oeIter> &oes, const WG_t &wg)
-{
-  std::vector<WG::eDesc> eedges;
+  for (const WG::eIndex &e : oes) {
+    const groupingId gp = Side::grouping(WG::getEdge(wg, e));
 
-  for (const WG::eDesc &e : oes) {
-    if (wg[e].gp2.empty())
-      eedges.push_back(e);
+    if (gp < width)
+      b.edges[b.count[gp]++] = e;
   }
 
-  return eedges;
+  for (const groupingId &gp : b.groupings)
+    b.count[gp] = 0;
 }
 
+template void WG::bucket<WG::Lhs>(const std::vector<WG::eIndex> &oes, const std::size_t &width, const WG_t &wg, WG::Buckets &b);
+template void WG::bucket<WG::Rhs>(const std::vector<WG::eIndex> &oes, const std::size_t &width, const WG_t &wg, WG::Buckets &b);
 
+/**
+ * the edges of the bucket of gp, valid until b is bucketed again.
+ */
+WG::bucketRange WG::getBucket(const WG::Buckets &b, const groupingId &gp)
+{
+  if (b.empty(gp))
+    return WG::bucketRange(b.edges.end(), b.edges.end());
 
+  const std::size_t i = b.slot[gp];
 
+  return WG::bucketRange(b.edges.begin() + b.offsets[i], b.edges.begin() + b.offsets[i + 1]);
+}
 
+std::vector<WG::vDesc> WG::getDestinations(const WG::bucketRange &es, const WG_t &wg)
+{
+  std::vector<WG::vDesc> dsts;
 
+  for (const WG::eIndex &e : es)
+    dsts.push_back(WG::getTarget(wg, e));
 
+  return dsts;
+}
 
-
-void WG::writeOutEdge(const WG_t &wg, const WG::eDesc &e, std::ostream& target)
+void WG::writeOutEdge(const WG_t &wg, const WG::eIndex &e, const DG_t &g1, const DG_t &g2,
+                      const groupingTable &gt, std::ostream& target)
 {
-  const WG::vDesc src = boost::source(e, wg);
-  const WG::vDesc dst = boost::target(e, wg);
+  const Csr<wgEdgeProps> &csr = wg[boost::graph_bundle].csr;
 
-  std::string gp1 = Alm::groupingToStr(wg[e].gp1);
-  std::string gp2 = Alm::groupingToStr(wg[e].gp2);
+  const WG::vDesc src = csr.source(e);
+  const WG::vDesc dst = csr.target(e);
+
+  std::string gp1 = Alm::groupingToStr(gt, csr.data(e).gp1);
+  std::string gp2 = Alm::groupingToStr(gt, csr.data(e).gp2);
 
   std::stringstream label;
 
@@ -477,28 +770,29 @@ void WG::writeOutEdge(const WG_t &wg, const WG::eDesc &e, std::ostream& target)
 
   label << "}";
 
-  target << "  \"" << wg[src].name << "\" ->  \"" << wg[dst].name << "\"";
+  target << "  \"" << WG::getVertexName(wg, src, g1, g2) << "\" ->  \"" << WG::getVertexName(wg, dst, g1, g2) << "\"";
   target << " [label=\"" << label.str() << "\", gp1=\"" << gp1 << "\", gp2=\"" << gp2 <<"\"]" << std::endl;
 
   return;
 }
 
-void WG::writeOutEdges(const WG_t &wg, const WG::vDesc &v, std::ostream& target)
+void WG::writeOutEdges(const WG_t &wg, const WG::vDesc &v, const DG_t &g1, const DG_t &g2,
+                       const groupingTable &gt, std::ostream& target)
 {
-  Range<WG::oeIter> oedges = Util::makeRange(boost::out_edges(v, wg));
+  WG::oeRange oedges = WG::getOutEdges(wg, v);
 
   if (oedges.empty())
     return;
 
-  for (const WG::eDesc &e : oedges)
-    writeOutEdge(wg, e, target);
+  for (const WG::eIndex &e : oedges)
+    writeOutEdge(wg, e, g1, g2, gt, target);
 
   Util::printLineFile(target);
 
   return;
 }
 
-void WG::write(const WG_t &wg, std::ostream& target)
+void WG::write(const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt, std::ostream& target)
 {
   target << "digraph {" << std::endl;
 
@@ -506,13 +800,13 @@ void WG::write(const WG_t &wg, std::ostream& target)
 
   for (const WG::vDesc &v : vertices) {
 
-    if (wg[v].role == "start") {
-      target << "  \"" << wg[v].name << "\" [role=\"start\"]" << std::endl;
+    if (Role::has(wg[v].role, Role::start)) {
+      target << "  \"" << WG::getVertexName(wg, v, g1, g2) << "\" [role=\"start\"]" << std::endl;
       continue;
     }
 
-    if (wg[v].role == "end") {
-      target << "  \"" << wg[v].name << "\" [role=\"end\"]" << std::endl;
+    if (Role::has(wg[v].role, Role::end)) {
+      target << "  \"" << WG::getVertexName(wg, v, g1, g2) << "\" [role=\"end\"]" << std::endl;
       continue;
     }
   }
@@ -520,7 +814,7 @@ void WG::write(const WG_t &wg, std::ostream& target)
   Util::printLineFile(target);
 
   for (const WG::vDesc &v : vertices)
-    WG::writeOutEdges(wg, v, target);
+    WG::writeOutEdges(wg, v, g1, g2, gt, target);
 
 
   target << "}" << std::endl;
@@ -528,54 +822,32 @@ void WG::write(const WG_t &wg, std::ostream& target)
   return;
 }
 
-void WG::print(const WG_t &wg)
+void WG::print(const WG_t &wg, const DG_t &g1, const DG_t &g2, const groupingTable &gt)
 {
 
-WG::write(wg,std::cout);
+WG::write(wg, g1, g2, gt, std::cout);
 
 }
 
 
-void WG::printOutEdgeDebug(const WG_t &wg, const WG::eDesc &e)
+void WG::printOutEdgeDebug(const WG_t &wg, const WG::eIndex &e)
 {
-  const WG::vDesc src = boost::source(e, wg);
-  const WG::vDesc dst = boost::target(e, wg);
-
-  std::string gp1 = Alm::groupingToStr(wg[e].gp1);
-  std::string gp2 = Alm::groupingToStr(wg[e].gp2);
-
-  std::stringstream label;
-
-  label << "{";
-
-  if (gp1 == "")
-    label << "-";
-  else
-    label << gp1;
-
-  label << "}, {";
-
-  if (gp2 == "")
-    label << "-";
-  else
-    label << gp2;
-
-  label << "}";
+  const Csr<wgEdgeProps> &csr = wg[boost::graph_bundle].csr;
 
-  DEBUG << "  \"" << wg[src].name << "\" ->  \"" << wg[dst].name << "\"";
-  DEBUG << " [label=\"" << label.str() << "\", gp1=\"" << gp1 << "\", gp2=\"" << gp2 <<"\"]" << std::endl;
+  DEBUG << "  \"" << csr.source(e) << "\" ->  \"" << csr.target(e) << "\"";
+  DEBUG << " [gp1=\"#" << csr.data(e).gp1 << "\", gp2=\"#" << csr.data(e).gp2 << "\"]" << std::endl;
 
   return;
 }
 
 void WG::printOutEdgesDebug(const WG_t &wg, const WG::vDesc &v)
 {
-  Range<WG::oeIter> oedges = Util::makeRange(boost::out_edges(v, wg));
+  WG::oeRange oedges = WG::getOutEdges(wg, v);
 
   if (oedges.empty())
     return;
 
-  for (const WG::eDesc &e : oedges)
+  for (const WG::eIndex &e : oedges)
     printOutEdgeDebug(wg, e);
 
   Util::printLineDebug();
@@ -52,6 +52,8 @@
 #include "json.hpp"
 using json = nlohmann::json;
 
+#include "AlignmentUtils.hpp"
+
 namespace AG
 {
   // forward declaration used by following type aliasing
@@ -73,10 +75,12 @@ namespace AG
   using binary_relation_t       = std::vector<std::pair<std::string, std::string>>;
   using binary_relation_short_t = std::vector<std::pair<short, short>>;
 
-  using label             = std::string;
-  using alignmentGroup    = std::vector<label>;
-  using alignmentPair     = std::pair<alignmentGroup, alignmentGroup>;
-  using alignment         = std::vector<alignmentPair>;
+  // iso-lib types, toDecisionAlignment produces alignments that can be
+  // passed to iso-lib directly.
+  using label             = ::label;
+  using alignmentGroup    = ::alignmentGroup;
+  using alignmentPair     = ::alignmentPair;
+  using alignment         = ::alignment;
 
   struct AlignmentNode
   {
@@ -118,6 +122,11 @@ namespace AG
     symbol_set_t symbolsLeft;
     symbol_set_t symbolsRight;
 
+    // label ids of the symbols, interned once so toDecisionAlignment
+    // does not take the label table's mutex for every symbol.
+    std::vector<labelId> labelsLeft;
+    std::vector<labelId> labelsRight;
+
     short symbolsLeftCount;
     short symbolsRightCount;
     short count;
@@ -170,6 +179,12 @@ namespace AG
       symbolsRightCount = symbolsRight.size();
       count = symbolsLeftCount + symbolsRightCount;
 
+      for (auto& s : symbolsLeft)
+        labelsLeft.push_back(Lbl::intern(s));
+
+      for (auto& s : symbolsRight)
+        labelsRight.push_back(Lbl::intern(s));
+
       // create empty root node
       root = std::make_shared<AlignmentNode>(0, 0);
       nodes.insert({root->id, root});
@@ -721,7 +736,7 @@ namespace AG
           {
             // if j is set in i, add it to the output
             if (node->left & (1 << j))
-              leftGroup.push_back(symbolsLeft[j]);
+              Alm::addLabel(leftGroup, labelsLeft[j]);
           }
 
           alignmentGroup rightGroup;
@@ -731,7 +746,7 @@ namespace AG
           {
             // if j is set in i, add it to the output
             if (node->right & (1 << j))
-              rightGroup.push_back(symbolsRight[j - symbolsLeftCount]);
+              Alm::addLabel(rightGroup, labelsRight[j - symbolsLeftCount]);
           }
 
           returnAlignment.push_back(std::make_pair(leftGroup, rightGroup));
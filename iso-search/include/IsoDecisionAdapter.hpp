@@ -15,6 +15,8 @@
 
 
 bool isCached = false;
+Graph_t g1Parsed;
+Graph_t g2Parsed;
 Graph_t g1Cache;
 Graph_t g2Cache;
 std::mutex cacheWriteMutex;
@@ -27,9 +29,14 @@ bool isIsotactic (std::string m1, std::string m2, alignment alm)
     
     if (! isCached)
     {
-      // read and parse the input automatons
-      g1Cache = Graph::parse(m1);
-      g2Cache = Graph::parse(m2);
+      // read and parse the input automatons. the comparison uses them
+      // without the states that can never reach an end state, see
+      // Graph::trim, the groupings are taken from all their labels.
+      g1Parsed = Graph::parse(m1);
+      g2Parsed = Graph::parse(m2);
+
+      g1Cache = Graph::trim(g1Parsed);
+      g2Cache = Graph::trim(g2Parsed);
     
       isCached = true;
     }
@@ -38,13 +45,20 @@ bool isIsotactic (std::string m1, std::string m2, alignment alm)
   Graph_t g1;
   Graph_t g2;
   
+  // copy_graph only copies vertices and edges, the graph properties (start
+  // and final states) have to be copied separately.
   copy_graph(g1Cache, g1);
   copy_graph(g2Cache, g2);
+
+  g1[boost::graph_bundle] = g1Cache[boost::graph_bundle];
+  g2[boost::graph_bundle] = g2Cache[boost::graph_bundle];
   
   // extract the sets of alignment groups for both the left and right side of the alignment.
-  // for each label assign the groups it is contained in.
-  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1, Alm::Lhs(alm));
-  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2, Alm::Rhs(alm));
+  // for each label assign the groups it is contained in. groupings are interned
+  // into gt, which is shared by both sides.
+  groupingTable gt;
+  labelGroupingMap lgm1 = Helper::LabelGroupingMap(g1Parsed, Alm::Lhs(alm), gt);
+  labelGroupingMap lgm2 = Helper::LabelGroupingMap(g2Parsed, Alm::Rhs(alm), gt);
 
   // helper: get just the alignment groups without knowing to which label they belong.
   edgeLabelSet els1 = Helper::lgmFlatten(lgm1);
@@ -57,16 +71,31 @@ bool isIsotactic (std::string m1, std::string m2, alignment alm)
   Helper::labelsToGroupings(g1, lgm1);
   Helper::labelsToGroupings(g2, lgm2);
 
+#if ISO_LIB_REDUCE_MODELS
+  // merge states that only differ in unaligned behavior, so it does not blow
+  // up the determinization. see Graph::reduce.
+  g1 = Graph::reduce(g1);
+  g2 = Graph::reduce(g2);
+#endif
+
   // remove non-determinism wrt. the alignment:
   // - merge edges (and vertices) that have the same set of alignment groups
   // - eliminate edges that have a label not contained in the alignment (epsilon-closure)
   DG_t dg1 = DG::determinize(g1, els1);
   DG_t dg2 = DG::determinize(g2, els2);
 
-  WG_t wg = WG::create(dg1, dg2, lgm1, lgm2, alm);
+#if ISO_LIB_MINIMIZE_DG
+  // merge equivalent states of the determinized models. see DG::minimize.
+  dg1 = DG::minimize(dg1);
+  dg2 = DG::minimize(dg2);
+#endif
+
+  // the witness graph is not written here, so it is only built as far as the
+  // comparison reads it. see WG::Builder.
+  WG_t wg;
+  WG::Builder wgb(wg, dg1, dg2, lgm1, lgm2, alm);
 
-  DWG_t dwg1 = DWG::createLhs(wg, els1);
-  bool leftEqual = Cmp::isEqual(dg1, dwg1, lgm1);
+  bool leftEqual = Cmp::isEqualLhs(dg1, wgb, els1);
   
   // if ! leftEqual, exit here and don't compute rightEqual
   if (! leftEqual)
@@ -74,8 +103,7 @@ bool isIsotactic (std::string m1, std::string m2, alignment alm)
   
   // assert(leftEqual)
   
-  DWG_t dwg2 = DWG::createRhs(wg, els2);
-  bool rightEqual = Cmp::isEqual(dg2, dwg2, lgm2);
+  bool rightEqual = Cmp::isEqualRhs(dg2, wgb, els2);
 
   // leftEqual was found to be true. if rightEqual then they are both true.
   return rightEqual;
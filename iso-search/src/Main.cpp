@@ -82,13 +82,13 @@ int main(int ac, char** av)
     for (auto edge : boost::make_iterator_range(boost::edges(g1)))
     {
       // std::cout << "edge1: " << g1[edge].label << "\n";
-      s1.push_back(g1[edge].label);
+      s1.push_back(Lbl::name(g1[edge].label));
     }
     
     for (auto edge : boost::make_iterator_range(boost::edges(g2)))
     {
       // std::cout << "edge2: " << g2[edge].label << "\n";
-      s2.push_back(g2[edge].label);
+      s2.push_back(Lbl::name(g2[edge].label));
     }
   }
   
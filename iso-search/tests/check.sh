@@ -0,0 +1,19 @@
+#!/bin/sh
+#
+# regression check for iso-search: runs the search on the models of an example
+# directory and compares the resulting vertices (alignment and verdict) with
+# expected.txt in that directory.
+#
+# usage: check.sh path/to/iso-search path/to/example
+#
+# the search runs multithreaded, so the order of the output and the parent
+# of a vertex in the search tree may differ between runs. only the sorted
+# vertex lines and the number of tests are compared.
+
+bin="$1"
+dir="$2"
+
+"$bin" "$dir/m1.dot" "$dir/m2.dot" 2>&1 \
+  | grep "fillcolor\|^iso tests" \
+  | LC_ALL=C sort \
+  | diff "$dir/expected.txt" -